@@ -0,0 +1,328 @@
+#include "CLI11.hpp"
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Runs test on a fixed matrix of configurations with fixed seeds and writes events/s, steps/s, peak RSS, output
+// size and initialisation time as JSON, e.g. bench -n 200 -t 8 -o bench.json --baseline previous.json
+// Each configuration runs in its own directory of the work directory. The run figures come from the --status file
+// of test, the peak RSS from the rusage of the child process, and the initialisation time is the wall time of the
+// process outside of the run (geometry, physics tables, output file closing). --run-managers mt,tasking runs each
+// configuration with both, to compare their throughput.
+
+namespace
+{
+namespace fs = std::filesystem;
+
+struct Configuration
+{
+    std::string particle{};
+    int         energy{}; // MeV/u
+    std::string material{};
+    bool        minimalTree = false;
+    int         nThreads{};
+    std::string runManager{};
+
+    // the default mt run manager keeps the names of the earlier baselines
+    std::string name() const
+    {
+        return particle + "_" + std::to_string(energy) + "_" + material + (minimalTree ? "_minimal" : "_full") + "_t"
+               + std::to_string(nThreads) + (runManager == "mt" ? "" : "_" + runManager);
+    }
+};
+
+// in the order of the columns of the table
+const std::vector<std::string> metricNames{"events_per_second", "steps_per_second", "peak_rss_bytes", "output_bytes",
+                                           "init_seconds"};
+
+// throughput metrics get worse when they decrease, the others when they increase
+bool higherIsBetter(const std::string& metric)
+{
+    return metric == "events_per_second" || metric == "steps_per_second";
+}
+
+using Result = std::map<std::string, double>;
+
+std::vector<Configuration> matrix(const int maxThreads, const std::vector<std::string>& runManagers)
+{
+    const std::vector<std::pair<std::string, int>> beams{
+        {"proton", 70}, {"proton", 150}, {"proton", 230}, {"carbon", 120}, {"carbon", 290}};
+
+    std::vector<int> threads{};
+    for (auto n = 1; n < maxThreads; n *= 2)
+        threads.push_back(n);
+    threads.push_back(maxThreads);
+
+    std::vector<Configuration> configurations{};
+    for (const auto& [particle, energy] : beams)
+        for (const auto& material : {"water", "waterGel"})
+            for (const auto minimalTree : {false, true})
+                for (const auto nThreads : threads)
+                    for (const auto& runManager : runManagers)
+                    {
+                        // next to each other in the table, the serial one only on 1 thread
+                        if (runManager != "serial" || nThreads == 1)
+                            configurations.push_back({particle, energy, material, minimalTree, nThreads, runManager});
+                    }
+
+    return configurations;
+}
+
+// "key": number pairs of a flat JSON file, as written by RunMetrics
+std::map<std::string, double> readNumbers(const std::string& text)
+{
+    static const std::regex pair{R"re("(\w+)"\s*:\s*(-?[0-9.eE+-]+))re"};
+
+    std::map<std::string, double> numbers{};
+    for (auto it = std::sregex_iterator(text.begin(), text.end(), pair); it != std::sregex_iterator(); ++it)
+        numbers[(*it)[1]] = std::stod((*it)[2]);
+
+    return numbers;
+}
+
+// one result per line, {"name": "...", metrics...}
+std::map<std::string, Result> readBaseline(const std::string& fileName)
+{
+    static const std::regex name{R"re("name"\s*:\s*"([^"]+)")re"};
+
+    std::ifstream file{fileName};
+    if (!file)
+        throw std::logic_error("cannot open the baseline " + fileName);
+
+    std::map<std::string, Result> baseline{};
+    std::string                   line{};
+    std::smatch                   match{};
+    while (std::getline(file, line))
+    {
+        if (std::regex_search(line, match, name))
+            baseline[match[1]] = readNumbers(line);
+    }
+
+    return baseline;
+}
+
+// returns false if the process failed
+bool run(const std::string& executable, const std::vector<std::string>& arguments, const fs::path& workDir,
+         rusage& usage)
+{
+    std::vector<char*> argv{};
+    argv.push_back(const_cast<char*>(executable.c_str()));
+    for (const auto& argument : arguments)
+        argv.push_back(const_cast<char*>(argument.c_str()));
+    argv.push_back(nullptr);
+
+    const auto pid = fork();
+    if (pid < 0)
+        return false;
+
+    if (pid == 0)
+    {
+        // the output of the simulation would hide the table
+        if (chdir(workDir.c_str()) != 0 || !std::freopen("test.log", "w", stdout)
+            || !std::freopen("test.log", "a", stderr))
+            _exit(127);
+        execv(executable.c_str(), argv.data());
+        _exit(127);
+    }
+
+    int status{};
+    if (wait4(pid, &status, 0, &usage) != pid)
+        return false;
+
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+Result measure(const std::string& executable, const Configuration& configuration, const fs::path& workDir,
+               const int nEvents, const int seed, const bool keepOutput)
+{
+    fs::remove_all(workDir);
+    fs::create_directories(workDir);
+
+    // the status file is only written at the end of the run
+    std::vector<std::string> arguments{"-N", configuration.particle, "-e", std::to_string(configuration.energy),
+                                       "-m", configuration.material, "-s", std::to_string(seed),
+                                       "-n", std::to_string(nEvents), "-t", std::to_string(configuration.nThreads),
+                                       "--run-manager", configuration.runManager,
+                                       "--status", "status", "--statusInterval", "3600"};
+
+    if (configuration.minimalTree)
+        arguments.push_back("--minimalTree");
+
+    rusage     usage{};
+    const auto beginTime = std::chrono::steady_clock::now();
+    const auto ok = run(executable, arguments, workDir, usage);
+
+    const std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - beginTime;
+
+    if (!ok)
+        throw std::logic_error(configuration.name() + " failed, see " + (workDir / "test.log").string());
+
+    std::ifstream     statusFile{workDir / "status.json"};
+    std::stringstream status{};
+    status << statusFile.rdbuf();
+    const auto numbers = readNumbers(status.str());
+
+    if (!numbers.count("elapsed_seconds"))
+        throw std::logic_error(configuration.name() + " : no status file");
+
+    double outputBytes = 0;
+    for (const auto& entry : fs::directory_iterator(workDir))
+    {
+        if (entry.path().extension() == ".root")
+            outputBytes += entry.file_size();
+    }
+
+    Result result{};
+    result["events_per_second"] = numbers.at("events_per_second");
+    result["steps_per_second"] = numbers.at("steps_per_second");
+    result["peak_rss_bytes"] = usage.ru_maxrss * 1024.; // kB on Linux
+    result["output_bytes"] = outputBytes;
+    result["init_seconds"] = wallTime.count() - numbers.at("elapsed_seconds");
+
+    if (!keepOutput)
+        fs::remove_all(workDir);
+
+    return result;
+}
+
+// relative change, positive when worse
+double regression(const std::string& metric, const double value, const double reference)
+{
+    if (reference == 0)
+        return 0;
+
+    const auto change = (value - reference) / reference;
+    return higherIsBetter(metric) ? -change : change;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app;
+
+    std::string executable{};
+    std::string workDir{};
+    std::string output{};
+    std::string baselineFile{};
+    std::string filter{};
+
+    std::vector<std::string> runManagers{};
+
+    int    nEvents{};
+    int    maxThreads{};
+    int    seed{};
+    int    nRepeats{};
+    double threshold{};
+    bool   keepOutput = false;
+
+    // test is built next to bench
+    const auto defaultExecutable = (fs::read_symlink("/proc/self/exe").parent_path() / "test").string();
+
+    app.add_option("--exe", executable, "simulation executable")->default_val(defaultExecutable);
+    app.add_option("-n", nEvents, "number of events per configuration")->default_val(200);
+    app.add_option("-t", maxThreads, "maximum number of threads, the matrix uses 1, 2, 4 ... up to it")
+        ->default_val(1)
+        ->check(CLI::PositiveNumber);
+    app.add_option("-s", seed, "seed of every configuration")->default_val(1);
+    app.add_option("--run-managers", runManagers, "comma separated run managers to compare : serial, mt, tasking, tbb")
+        ->default_val("mt")
+        ->delimiter(',');
+    app.add_option("-r", nRepeats, "runs per configuration, the fastest one is kept")
+        ->default_val(1)
+        ->check(CLI::PositiveNumber);
+    app.add_option("-o", output, "results in JSON")->default_val("bench.json");
+    app.add_option("--workDir", workDir, "directory of the runs")->default_val("bench_runs");
+    app.add_option("--filter", filter, "only the configurations whose name contains this, e.g. carbon_290_water_");
+    app.add_option("--baseline", baselineFile, "results of a previous bench run to compare with")
+        ->check(CLI::ExistingFile);
+    app.add_option("--threshold", threshold, "relative regression above which bench fails")->default_val(0.1);
+    app.add_flag("--keep", keepOutput, "keep the output files and logs of the runs");
+
+    CLI11_PARSE(app, argc, argv);
+
+    const auto baseline = baselineFile.empty() ? std::map<std::string, Result>{} : readBaseline(baselineFile);
+
+    std::ofstream json{output};
+    json << "{\n"
+         << "  \"events\": " << nEvents << ",\n"
+         << "  \"seed\": " << seed << ",\n"
+         << "  \"results\": [\n";
+
+    std::cout << std::left << std::setw(42) << "configuration";
+    for (const auto& metric : metricNames)
+        std::cout << std::right << std::setw(20) << metric;
+    std::cout << std::endl;
+
+    bool first = true;
+    auto   nRegressions = 0;
+
+    for (const auto& configuration : matrix(maxThreads, runManagers))
+    {
+        const auto name = configuration.name();
+        if (name.find(filter) == std::string::npos)
+            continue;
+
+        Result result{};
+        for (auto i = 0; i < nRepeats; ++i)
+        {
+            const auto repeat = measure(executable, configuration, fs::path{workDir} / name, nEvents, seed, keepOutput);
+            if (result.empty() || repeat.at("events_per_second") > result.at("events_per_second"))
+                result = repeat;
+        }
+
+        json << (first ? "" : ",\n") << "    {\"name\": \"" << name << "\"";
+        for (const auto& metric : metricNames)
+            json << ", \"" << metric << "\": " << std::setprecision(10) << result.at(metric);
+        json << "}" << std::flush;
+        first = false;
+
+        std::cout << std::left << std::setw(42) << name << std::right << std::fixed << std::setprecision(3);
+        for (const auto& metric : metricNames)
+            std::cout << std::setw(20) << result.at(metric);
+        std::cout << std::endl;
+
+        const auto reference = baseline.find(name);
+        if (reference == baseline.end())
+            continue;
+
+        std::cout << std::left << std::setw(42) << "  worse than baseline, %" << std::right << std::showpos
+                  << std::setprecision(1);
+        for (const auto& metric : metricNames)
+        {
+            const auto referenceValue = reference->second.count(metric) ? reference->second.at(metric) : 0.;
+            const auto change = regression(metric, result.at(metric), referenceValue);
+
+            // positive is worse whatever the metric
+            std::cout << std::setw(19) << 100 * change << (change > threshold ? "!" : " ");
+            if (change > threshold)
+                nRegressions++;
+        }
+        std::cout << std::noshowpos << std::endl;
+    }
+
+    json << "\n  ]\n}\n";
+
+    if (nRegressions > 0)
+    {
+        std::cerr << "bench : " << nRegressions << " metrics regressed by more than " << 100 * threshold << "%"
+                  << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
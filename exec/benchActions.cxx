@@ -0,0 +1,445 @@
+#include "CLI11.hpp"
+#include "DetectorConstruction.h"
+#include "PhysicsList.h"
+#include "RootWriter.h"
+#include "Settings.h"
+#include "SteppingAction.h"
+#include "TrackInformation.h"
+#include "TrackingAction.h"
+
+#include <CLHEP/Units/SystemOfUnits.h>
+
+#include <G4DynamicParticle.hh>
+#include <G4IonTable.hh>
+#include <G4ParticleTable.hh>
+#include <G4PhysicalVolumeStore.hh>
+#include <G4RunManagerFactory.hh>
+#include <G4Step.hh>
+#include <G4Track.hh>
+#include <G4VTouchable.hh>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TTreeReader.h>
+#include <TTreeReaderArray.h>
+#include <TTreeReaderValue.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Time of the user action hot paths (TrackingAction, SteppingAction::HandleBeamInBody and the RootWriter adders and
+// fillTree) without any transport : the events of an output file of test (full, non compact tree) are replayed as
+// synthetic G4Track and G4Step objects, e.g. benchActions -i proton_150_wg_1.root -r 10
+// Each hot path is timed in its own pass over the events, the geometry and particles come from a serial run manager
+// initialised with the detector and physics list of test.
+
+namespace
+{
+// touchable of a single volume, all the user actions look at
+class VolumeTouchable : public G4VTouchable
+{
+  public:
+    explicit VolumeTouchable(G4VPhysicalVolume* volume)
+        : volume(volume)
+    {
+    }
+
+    const G4ThreeVector&    GetTranslation(G4int = 0) const override { return translation; }
+    const G4RotationMatrix* GetRotation(G4int = 0) const override { return nullptr; }
+    G4VPhysicalVolume*      GetVolume(G4int = 0) const override { return volume; }
+
+  protected:
+    G4VPhysicalVolume* volume = nullptr;
+    G4ThreeVector      translation{};
+};
+
+struct Nucleus
+{
+    const G4ParticleDefinition* particleDefinition = nullptr;
+    G4ThreeVector               position{};
+};
+
+// owns the tracks its steps point to
+struct ReplayEvent
+{
+    G4ThreeVector primaryEnd{};
+
+    std::vector<std::unique_ptr<G4Track>> tracks{}; // in tracking order, the primary first
+    std::vector<Nucleus>                  nuclei{};
+    std::vector<std::unique_ptr<G4Step>>  escapingSteps{};
+    std::vector<std::unique_ptr<G4Step>>  beamSteps{};
+};
+
+struct Timer
+{
+    const char*   name = "";
+    std::uint64_t nCalls{};
+    G4double      seconds{};
+
+    template <typename F>
+    void time(const std::size_t n, F&& f)
+    {
+        const auto begin = std::chrono::steady_clock::now();
+        f();
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - begin;
+
+        nCalls += n;
+        seconds += time.count();
+    }
+};
+
+class Replay
+{
+  public:
+    Replay(const G4String& beamParticle)
+        : particleTable(G4ParticleTable::GetParticleTable())
+        , ionTable(G4IonTable::GetIonTable())
+        , worldHandle(new VolumeTouchable(G4PhysicalVolumeStore::GetInstance()->GetVolume("World")))
+        , bodyHandle(new VolumeTouchable(G4PhysicalVolumeStore::GetInstance()->GetVolume("Body")))
+        , beamParticle(beamParticle == "proton" ? particleTable->FindParticle("proton") : ionTable->GetIon(6, 12))
+    {
+    }
+
+    std::vector<ReplayEvent> read(const std::string& fileName, const G4int maxEvents, const G4int nBeamSteps);
+
+  protected:
+    const G4ParticleDefinition* findParticle(const G4int pdg) const
+    {
+        const auto particleDefinition = pdg > 1000000000 ? ionTable->GetIon(pdg) : particleTable->FindParticle(pdg);
+        return particleDefinition ? particleDefinition : particleTable->FindParticle("geantino");
+    }
+
+    G4Track* addTrack(ReplayEvent&                event,
+                      const G4ParticleDefinition* particleDefinition,
+                      const G4ThreeVector&        position,
+                      const G4ThreeVector&        direction,
+                      const G4double              kineticEnergy,
+                      const G4double              time,
+                      const G4int                 parentID) const
+    {
+        auto track = std::make_unique<G4Track>(new G4DynamicParticle(particleDefinition, direction, kineticEnergy),
+                                               time, position);
+        track->SetTrackID(static_cast<G4int>(event.tracks.size()) + 1);
+        track->SetParentID(parentID);
+        track->SetTouchableHandle(position.z() < 0 ? worldHandle : bodyHandle);
+
+        event.tracks.push_back(std::move(track));
+        return event.tracks.back().get();
+    }
+
+    G4Step* addStep(std::vector<std::unique_ptr<G4Step>>& steps,
+                    G4Track*                              track,
+                    const G4ThreeVector&                  prePosition,
+                    const G4ThreeVector&                  postPosition,
+                    const G4TouchableHandle&              postTouchable) const
+    {
+        auto step = std::make_unique<G4Step>();
+        step->SetTrack(track);
+
+        const auto preStepPoint = step->GetPreStepPoint();
+        preStepPoint->SetPosition(prePosition);
+        preStepPoint->SetTouchableHandle(bodyHandle);
+
+        const auto postStepPoint = step->GetPostStepPoint();
+        postStepPoint->SetPosition(postPosition);
+        postStepPoint->SetTouchableHandle(postTouchable);
+        postStepPoint->SetMass(track->GetDynamicParticle()->GetMass());
+        postStepPoint->SetKineticEnergy(track->GetKineticEnergy());
+        postStepPoint->SetMomentumDirection(track->GetMomentumDirection());
+        postStepPoint->SetGlobalTime(track->GetGlobalTime());
+
+        steps.push_back(std::move(step));
+        return steps.back().get();
+    }
+
+  protected:
+    G4ParticleTable* particleTable = nullptr;
+    G4IonTable*      ionTable = nullptr;
+
+    G4TouchableHandle worldHandle{};
+    G4TouchableHandle bodyHandle{};
+
+    const G4ParticleDefinition* beamParticle = nullptr;
+};
+
+std::vector<ReplayEvent> Replay::read(const std::string& fileName, const G4int maxEvents, const G4int nBeamSteps)
+{
+    const auto file = std::unique_ptr<TFile>(TFile::Open(fileName.c_str()));
+    if (!file || file->IsZombie())
+        throw std::logic_error("cannot open " + fileName);
+
+    const auto tree = file->Get<TTree>("tree");
+    if (!tree)
+        throw std::logic_error(fileName + " has no tree");
+
+    for (const auto name : {"primaryEndX", "A", "nucleiA", "pdgEsc", "thetaEsc", "initialXEsc"})
+    {
+        if (!tree->GetBranch(name))
+            throw std::logic_error(fileName + " has no " + name + " column, the replay needs the full tree");
+    }
+    if (tree->GetBranch("positionResolution"))
+        throw std::logic_error(fileName + " is a compact tree");
+
+    TTreeReader reader{tree};
+
+    TTreeReaderValue<float> primaryEndX{reader, "primaryEndX"};
+    TTreeReaderValue<float> primaryEndY{reader, "primaryEndY"};
+    TTreeReaderValue<float> primaryEndZ{reader, "primaryEndZ"};
+
+    TTreeReaderArray<int>   A{reader, "A"};
+    TTreeReaderArray<int>   Z{reader, "Z"};
+    TTreeReaderArray<float> x{reader, "x"};
+    TTreeReaderArray<float> y{reader, "y"};
+    TTreeReaderArray<float> z{reader, "z"};
+    TTreeReaderArray<float> t{reader, "t"};
+
+    TTreeReaderArray<int>   nucleiA{reader, "nucleiA"};
+    TTreeReaderArray<int>   nucleiZ{reader, "nucleiZ"};
+    TTreeReaderArray<float> nucleiXPos{reader, "nucleiXPos"};
+    TTreeReaderArray<float> nucleiYPos{reader, "nucleiYPos"};
+    TTreeReaderArray<float> nucleiZPos{reader, "nucleiZPos"};
+
+    TTreeReaderArray<int>   pdgEsc{reader, "pdgEsc"};
+    TTreeReaderArray<float> xEsc{reader, "xEsc"};
+    TTreeReaderArray<float> yEsc{reader, "yEsc"};
+    TTreeReaderArray<float> zEsc{reader, "zEsc"};
+    TTreeReaderArray<float> thetaEsc{reader, "thetaEsc"};
+    TTreeReaderArray<float> phiEsc{reader, "phiEsc"};
+    TTreeReaderArray<float> eEsc{reader, "eEsc"};
+    TTreeReaderArray<float> timeEsc{reader, "timeEsc"};
+    TTreeReaderArray<float> initialXEsc{reader, "initialXEsc"};
+    TTreeReaderArray<float> initialYEsc{reader, "initialYEsc"};
+    TTreeReaderArray<float> initialZEsc{reader, "initialZEsc"};
+
+    const auto positron = particleTable->FindParticle("e+");
+    const auto beamStart = G4ThreeVector{0, 0, -20 * CLHEP::cm};
+    const auto beamDirection = G4ThreeVector{0, 0, 1};
+
+    std::vector<ReplayEvent> events{};
+
+    while (static_cast<G4int>(events.size()) < maxEvents && reader.Next())
+    {
+        auto& event = events.emplace_back();
+
+        // the tree stores the values divided by their unit
+        event.primaryEnd = G4ThreeVector{*primaryEndX, *primaryEndY, *primaryEndZ} * CLHEP::mm;
+
+        const auto primary = addTrack(event, beamParticle, beamStart, beamDirection, 0, 0, 0);
+
+        // straight steps through the body up to the end of the primary
+        const auto bodyEntrance = G4ThreeVector{0, 0, 0};
+        for (auto i = 0; i < nBeamSteps; ++i)
+        {
+            const auto pre = bodyEntrance + (event.primaryEnd - bodyEntrance) * i / nBeamSteps;
+            const auto post = bodyEntrance + (event.primaryEnd - bodyEntrance) * (i + 1) / nBeamSteps;
+            addStep(event.beamSteps, primary, pre, post, bodyHandle)->SetTotalEnergyDeposit(1 * CLHEP::MeV);
+        }
+
+        for (std::size_t i = 0; i < nucleiA.GetSize(); ++i)
+        {
+            const auto position = G4ThreeVector{nucleiXPos[i], nucleiYPos[i], nucleiZPos[i]} * CLHEP::mm;
+            const auto particleDefinition = ionTable->GetIon(nucleiZ[i], nucleiA[i]);
+            if (!particleDefinition)
+                continue;
+
+            event.nuclei.push_back({particleDefinition, position});
+            addTrack(event, particleDefinition, position, beamDirection, 0, 0, 1);
+        }
+
+        // the positron of each emitter, so that its parent is the emitter
+        for (std::size_t i = 0; i < A.GetSize(); ++i)
+        {
+            const auto position = G4ThreeVector{x[i], y[i], z[i]} * CLHEP::mm;
+            const auto emitter = ionTable->GetIon(Z[i], A[i]);
+            if (!emitter)
+                continue;
+
+            const auto emitterTrack = addTrack(event, emitter, position, beamDirection, 0, 0, 1);
+            addTrack(event, positron, position, beamDirection, 0, t[i] * CLHEP::s, emitterTrack->GetTrackID());
+        }
+
+        for (std::size_t i = 0; i < pdgEsc.GetSize(); ++i)
+        {
+            const auto particleDefinition = findParticle(pdgEsc[i]);
+
+            auto direction = G4ThreeVector{0, 0, 1};
+            direction.setTheta(thetaEsc[i] * CLHEP::rad);
+            direction.setPhi(phiEsc[i] * CLHEP::rad);
+
+            const auto kineticEnergy = std::max(eEsc[i] * CLHEP::MeV - particleDefinition->GetPDGMass(), 0.);
+            const auto initialPosition = G4ThreeVector{initialXEsc[i], initialYEsc[i], initialZEsc[i]} * CLHEP::mm;
+            const auto position = G4ThreeVector{xEsc[i], yEsc[i], zEsc[i]} * CLHEP::mm;
+
+            const auto track = addTrack(event, particleDefinition, initialPosition, direction, kineticEnergy,
+                                        timeEsc[i] * CLHEP::s, 1);
+            addStep(event.escapingSteps, track, position - direction * CLHEP::mm, position, worldHandle);
+        }
+    }
+
+    return events;
+}
+
+// the hot path is protected
+class BenchSteppingAction : public SteppingAction
+{
+  public:
+    using SteppingAction::HandleBeamInBody;
+    using SteppingAction::SteppingAction;
+};
+} // namespace
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+
+    CLI::App app;
+
+    auto settings = Settings{};
+
+    std::string input{};
+    std::string output{};
+
+    G4int nEvents{};
+    G4int nRepeats{};
+    G4int nBeamSteps{};
+
+    app.add_option("-i", input, "output file of test with the full tree, e.g. proton_150_wg_1.root")
+        ->required()
+        ->check(CLI::ExistingFile);
+    app.add_option("-o", output, "temporary output file")->default_val("benchActions.root");
+    app.add_option("-n", nEvents, "maximum number of events read from the input")->default_val(1000);
+    app.add_option("-r", nRepeats, "passes over the events")->default_val(10);
+    app.add_option("--beamSteps", nBeamSteps, "steps of the primary in the body per event")->default_val(100);
+    app.add_option("-N", settings.particleName, "beam particle of the input : proton or carbon")
+        ->default_val("proton");
+    app.add_option("-m", settings.bodyMaterial, "body material of the input : water or waterGel")
+        ->default_val("waterGel");
+    app.add_option("--backend", settings.outputBackend, "output backend : g4, tree or rntuple")->default_val("tree");
+    app.add_flag("--compact", settings.compactTree, "store positions, energies, times and angles as 16 bit codes");
+
+    CLI11_PARSE(app, argc, argv);
+
+    settings.bodyWidth = 15;
+
+    // geometry and particles, no transport
+    const auto runManager =
+        std::unique_ptr<G4RunManager>(G4RunManagerFactory::CreateRunManager(G4RunManagerType::SerialOnly));
+    runManager->SetUserInitialization(new DetectorConstruction(settings));
+    runManager->SetUserInitialization(new PhysicsList);
+    runManager->Initialize();
+
+    const auto events = Replay{settings.particleName}.read(input, nEvents, nBeamSteps);
+
+    auto rootWriter = RootWriter{settings};
+    rootWriter.openRootFile(output);
+
+    auto trackingAction = TrackingAction{&rootWriter, nullptr};
+    auto steppingAction = BenchSteppingAction{&rootWriter, &trackingAction, nullptr, settings};
+
+    Timer preTracking{"PreUserTrackingAction"};
+    Timer reset{"TrackingAction::reset"};
+    Timer addEscapingParticle{"addEscapingParticle"};
+    Timer addNuclei{"addNuclei"};
+    Timer handleBeamInBody{"HandleBeamInBody"};
+    Timer fillTree{"fillTree"};
+
+    for (auto repeat = 0; repeat < nRepeats; ++repeat)
+    {
+        // also attaches the TrackInformation the other passes need
+        for (const auto& event : events)
+        {
+            for (const auto& track : event.tracks)
+            {
+                delete track->GetUserInformation();
+                track->SetUserInformation(nullptr);
+            }
+
+            preTracking.time(event.tracks.size(),
+                             [&]
+                             {
+                                 for (const auto& track : event.tracks)
+                                     trackingAction.PreUserTrackingAction(track.get());
+                             });
+
+            reset.time(1, [&] { trackingAction.reset(); });
+
+            rootWriter.rejectEvent();
+        }
+
+        for (const auto& event : events)
+        {
+            addEscapingParticle.time(event.escapingSteps.size(),
+                                     [&]
+                                     {
+                                         for (const auto& step : event.escapingSteps)
+                                             rootWriter.addEscapingParticle(step.get());
+                                     });
+
+            rootWriter.rejectEvent();
+        }
+
+        for (const auto& event : events)
+        {
+            addNuclei.time(event.nuclei.size(),
+                           [&]
+                           {
+                               for (const auto& [particleDefinition, position] : event.nuclei)
+                                   rootWriter.addNuclei(particleDefinition, position);
+                           });
+
+            rootWriter.rejectEvent();
+        }
+
+        for (const auto& event : events)
+        {
+            handleBeamInBody.time(event.beamSteps.size(),
+                                  [&]
+                                  {
+                                      for (const auto& step : event.beamSteps)
+                                          steppingAction.HandleBeamInBody(step.get());
+                                  });
+        }
+
+        // the whole event, as written by test
+        for (const auto& event : events)
+        {
+            for (const auto& track : event.tracks)
+            {
+                delete track->GetUserInformation();
+                track->SetUserInformation(nullptr);
+                trackingAction.PreUserTrackingAction(track.get());
+            }
+            for (const auto& step : event.escapingSteps)
+                rootWriter.addEscapingParticle(step.get());
+            rootWriter.setPrimaryEnd(event.primaryEnd);
+            trackingAction.reset();
+
+            fillTree.time(1, [&] { rootWriter.fillTree(); });
+        }
+    }
+
+    rootWriter.closeRootFile();
+    fs::remove(output);
+
+    std::cout << events.size() << " events replayed " << nRepeats << " times" << std::endl;
+    std::cout << std::setw(24) << "hot path" << std::setw(14) << "calls" << std::setw(12) << "ns/call"
+              << std::setw(14) << "Mcalls/s" << std::endl;
+
+    for (const auto& timer : {preTracking, reset, addEscapingParticle, addNuclei, handleBeamInBody, fillTree})
+    {
+        const auto nCalls = static_cast<G4double>(std::max<std::uint64_t>(timer.nCalls, 1));
+        std::cout << std::setw(24) << timer.name << std::setw(14) << timer.nCalls << std::setw(12) << std::fixed
+                  << std::setprecision(1) << 1e9 * timer.seconds / nCalls << std::setw(14) << std::setprecision(3)
+                  << nCalls / timer.seconds / 1e6 << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include "CLI11.hpp"
+#include "CompactEncoding.h"
+#include "EventRecord.h"
+#include "G4AnalysisBackend.h"
+#include "RNTupleBackend.h"
+#include "Settings.h"
+#include "TreeBackend.h"
+
+#include <CLHEP/Units/SystemOfUnits.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Write throughput and file size of the output backends for the different compression settings,
+// on synthetic events shaped like the full tree of a carbon run, without any transport.
+
+namespace
+{
+void fillSyntheticEvent(EventRecord& record, std::mt19937& gen, const int eventID)
+{
+    std::poisson_distribution<> nEmitters{3};
+    std::poisson_distribution<> nNuclei{60};
+    std::poisson_distribution<> nEscaping{40};
+
+    std::normal_distribution<>       transverse{0, 5 * CLHEP::mm};
+    std::uniform_real_distribution<> depth{0, 200 * CLHEP::mm};
+    std::uniform_real_distribution<> flat{0, 1};
+    std::exponential_distribution<>  decayTime{1 / (20 * 60 * CLHEP::s)};
+    std::exponential_distribution<>  energy{1 / (2 * CLHEP::MeV)};
+
+    record.eventID.set(eventID);
+    record.primaryEndX.set(transverse(gen));
+    record.primaryEndY.set(transverse(gen));
+    record.primaryEndZ.set(depth(gen));
+
+    for (auto i = nEmitters(gen); i > 0; --i)
+    {
+        record.A.add(11);
+        record.Z.add(6);
+        record.x.add(transverse(gen));
+        record.y.add(transverse(gen));
+        record.z.add(depth(gen));
+        record.t.add(decayTime(gen));
+    }
+
+    for (auto i = nNuclei(gen); i > 0; --i)
+    {
+        record.nucleiA.add(1);
+        record.nucleiZ.add(1);
+        record.nucleiXPos.add(transverse(gen));
+        record.nucleiYPos.add(transverse(gen));
+        record.nucleiZPos.add(depth(gen));
+    }
+
+    for (auto i = nEscaping(gen); i > 0; --i)
+    {
+        const auto phi = (2 * flat(gen) - 1) * CLHEP::pi;
+        record.pdgEsc.add(flat(gen) < 0.7 ? 22 : 2112);
+        record.xEsc.add(150 * CLHEP::mm * std::cos(phi));
+        record.yEsc.add(150 * CLHEP::mm * std::sin(phi));
+        record.zEsc.add(depth(gen));
+        record.thetaEsc.add(flat(gen) * CLHEP::pi);
+        record.phiEsc.add(phi);
+        record.eEsc.add(energy(gen));
+        record.timeEsc.add(flat(gen) * 2 * CLHEP::ns);
+        record.initialXEsc.add(transverse(gen));
+        record.initialYEsc.add(transverse(gen));
+        record.initialZEsc.add(depth(gen));
+    }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+
+    CLI::App app;
+
+    int         nEvents{};
+    bool        compact = false;
+    std::string outputDir{};
+
+    std::vector<std::string> backends{};
+    std::vector<std::string> algorithms{};
+    std::vector<int>         levels{};
+    std::vector<int>         basketSizes{};
+    std::vector<long>        autoFlushes{};
+
+    app.add_option("-n", nEvents, "number of events per setting")->default_val(20000);
+    app.add_option("-o", outputDir, "directory of the temporary files")->default_val(".");
+    app.add_option("--backends", backends, "backends")->delimiter(',')->default_val("g4,tree,rntuple");
+    app.add_option("--compression", algorithms, "algorithms")->delimiter(',')->default_val("zlib,lz4,zstd,lzma");
+    app.add_option("--levels", levels, "compression levels")->delimiter(',')->default_val("1,5,9");
+    app.add_option("--basketSizes", basketSizes, "basket sizes in bytes")->delimiter(',')->default_val("32000");
+    app.add_option("--autoFlushes", autoFlushes, "auto flush settings")->delimiter(',')->default_val("-30000000");
+    app.add_flag("--compact", compact, "use the compact encoding");
+
+    CLI11_PARSE(app, argc, argv);
+
+    struct Setting
+    {
+        std::string backend{};
+        Settings    settings{};
+    };
+
+    std::vector<Setting> benchSettings{};
+
+    auto settings = Settings{};
+    settings.compactTree = compact;
+
+    for (const auto& backend : backends)
+    {
+        // the compression settings do not apply to the g4 backend
+        if (backend == "g4")
+        {
+            benchSettings.push_back({backend, settings});
+            continue;
+        }
+
+        for (const auto& algorithm : algorithms)
+            for (const auto level : levels)
+                for (const auto basketSize : basketSizes)
+                    for (const auto autoFlush : autoFlushes)
+                    {
+                        settings.compressionAlgorithm = algorithm;
+                        settings.compressionLevel = level;
+                        settings.basketSize = basketSize;
+                        settings.autoFlush = autoFlush;
+                        benchSettings.push_back({backend, settings});
+                    }
+    }
+
+    std::cout << std::setw(8) << "backend" << std::setw(8) << "algo" << std::setw(7) << "level" << std::setw(10)
+              << "basket" << std::setw(11) << "autoFlush" << std::setw(12) << "events/s" << std::setw(10) << "MB/s"
+              << std::setw(12) << "size (MB)" << std::setw(8) << "ratio" << std::endl;
+
+    for (const auto& [backendName, benchSetting] : benchSettings)
+    {
+        const auto fileName = (fs::path{outputDir} / "benchOutput.root").string();
+
+        auto record = std::make_unique<EventRecord>();
+        record->setCompact(benchSetting.compactTree);
+
+        const auto encoding = CompactEncoding{benchSetting.positionResolution, benchSetting.logStep};
+
+        std::unique_ptr<OutputBackend> backend = nullptr;
+        if (backendName == "g4")
+            backend = std::make_unique<G4AnalysisBackend>(false);
+        else if (backendName == "tree")
+            backend = std::make_unique<TreeBackend>(benchSetting, true, true);
+        else
+            backend = std::make_unique<RNTupleBackend>(benchSetting, true, true);
+
+        // same events for every setting
+        std::mt19937 gen{42};
+        double       payloadBytes = 0;
+
+        const auto begin = std::chrono::steady_clock::now();
+
+        backend->open(fileName, *record);
+
+        for (auto event = 0; event < nEvents; ++event)
+        {
+            fillSyntheticEvent(*record, gen, event);
+
+            if (benchSetting.compactTree)
+                record->encode(encoding);
+
+            payloadBytes += record->payloadBytes();
+
+            backend->fill();
+            record->clear();
+        }
+
+        backend->close();
+
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - begin;
+
+        const auto fileSize = static_cast<double>(fs::file_size(fileName));
+
+        const auto algorithm = backendName == "g4" ? std::string{"-"} : std::string{benchSetting.compressionAlgorithm};
+
+        std::cout << std::setw(8) << backendName << std::setw(8) << algorithm << std::setw(7)
+                  << benchSetting.compressionLevel << std::setw(10) << benchSetting.basketSize << std::setw(11)
+                  << benchSetting.autoFlush << std::setw(12) << std::fixed << std::setprecision(0)
+                  << nEvents / time.count() << std::setw(10) << std::setprecision(1)
+                  << payloadBytes / 1e6 / time.count() << std::setw(12) << fileSize / 1e6 << std::setw(8)
+                  << std::setprecision(2) << payloadBytes / fileSize << std::endl;
+
+        fs::remove(fileName);
+    }
+
+    return 0;
+}
@@ -0,0 +1,51 @@
+#include "CLI11.hpp"
+#include "OutputBackend.h"
+#include "OutputMerger.h"
+
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Merges the files written with --perWorkerFiles, e.g. mergeOutput -o run.root run_t*.root
+
+int main(int argc, char** argv)
+{
+    namespace fs = std::filesystem;
+
+    CLI::App app;
+
+    std::vector<std::string> inputs{};
+    std::string              output{};
+    std::string              algorithm{};
+
+    int  nThreads{};
+    int  level{};
+    bool removeInputs = false;
+
+    app.add_option("inputs", inputs, "per-worker files")->required()->check(CLI::ExistingFile);
+    app.add_option("-o", output, "merged file")->required();
+    app.add_option("-j", nThreads, "number of threads")->default_val(std::thread::hardware_concurrency());
+    app.add_option("--compression", algorithm, "zlib, lzma, lz4 or zstd")->default_val("zstd");
+    app.add_option("--compressionLevel", level, "compression level")->default_val(5);
+    app.add_flag("--rm", removeInputs, "remove the per-worker files after a successful merge");
+
+    CLI11_PARSE(app, argc, argv);
+
+    const auto merger = OutputMerger{nThreads, OutputBackend::compressionSettings(algorithm, level)};
+
+    if (!merger.merge(inputs, output))
+    {
+        std::cerr << "mergeOutput : failed to merge into " << output << std::endl;
+        return 1;
+    }
+
+    if (removeInputs)
+    {
+        for (const auto& input : inputs)
+            fs::remove(input);
+    }
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include "CLI11.hpp"
+#include "CompactEncoding.h"
 
 #include <ROOT/RDFHelpers.hxx>
 #include <ROOT/RDataFrame.hxx>
@@ -9,10 +10,12 @@
 #include <TH1.h>
 #include <TLegend.h>
 #include <TLegendEntry.h>
+#include <TParameter.h>
 #include <TROOT.h>
 #include <TStyle.h>
 #include <TTree.h>
 
+#include <cstdint>
 #include <filesystem>
 #include <limits>
 #include <ostream>
@@ -63,7 +66,8 @@ int main(int argc, char** argv)
     const auto fileStem = fs::path{fileName}.stem().string();
 
     auto inputFile = TFile::Open(fileName.c_str(), "READ");
-    auto inputTree = dynamic_cast<TTree*>(inputFile->Get("tree"));
+    // TTree or RNTuple depending on the output backend, RDataFrame reads both
+    const auto inputTreeKey = inputFile->GetKey("tree");
 
     const auto histoDose2D = dynamic_cast<TH2D*>(inputFile->Get("hs"));
     const auto histoDose = histoDose2D->ProjectionX();
@@ -73,18 +77,23 @@ int main(int argc, char** argv)
 
     const auto braggPeakDepth = histoDose->GetBinCenter(histoDose->GetMaximumBin());
 
-    if (!inputTree)
+    if (!inputTreeKey)
     {
         std::cout << "ERROR : no tree" << std::endl;
         return 1;
     }
 
-    auto inputDF = ROOT::RDataFrame{*inputTree};
+    auto inputDF = ROOT::RDataFrame{"tree", fileName};
 
-    const ULong64_t nEvents = inputDF.Count().GetValue();
+    const ULong64_t nEntries = inputDF.Count().GetValue();
+
+    // events rejected by the triggers were simulated but not written
+    const auto      nRejectedParameter = inputFile->Get<TParameter<Long64_t>>("nRejectedEvents");
+    const ULong64_t nRejected = nRejectedParameter ? nRejectedParameter->GetVal() : 0;
+    const ULong64_t nEvents = nEntries + nRejected;
     auto            irrTime = std::stod(irrTimeStr);
 
-    std::cout << "nHadrons in file = " << nEvents << '\n'
+    std::cout << "nHadrons in file = " << nEvents << " (" << nRejected << " rejected by the triggers)" << '\n'
               << "irradiationTime = " << irrTime << " minutes" << '\n'
               << "nHadrons target = " << nIrrad << '\n'
               << "measure from " << timeBegin << " to " << timeEnd << " minutes after irradiation" << '\n'
@@ -94,8 +103,45 @@ int main(int argc, char** argv)
     timeEnd *= 60;
     irrTime *= 60;
 
-    auto data = inputDF.Define(
-        "eventTime", [&](const ULong64_t& event) { return irrTime * ((1. * event / nEvents) - 1); }, {"rdfentry_"});
+    // position of the event in the irradiation, from its ID when some events were rejected
+    const auto eventTime = [&](const double eventIndex, const double nIndices)
+    { return irrTime * ((eventIndex / nIndices) - 1); };
+
+    auto data = nRejected > 0 && inputDF.HasColumn("eventID")
+                    ? inputDF.Define(
+                          "eventTime", [&](const int& eventID) { return eventTime(eventID, nEvents); }, {"eventID"})
+                    : inputDF.Define(
+                          "eventTime", [&](const ULong64_t& entry) { return eventTime(entry, nEntries); },
+                          {"rdfentry_"});
+
+    // compact trees store 16 bit codes instead of mm and s, see CompactEncoding
+    if (inputDF.HasColumn("positionResolution"))
+    {
+        std::cout << "compact tree, decoding positions and times" << std::endl;
+
+        // code is only there for its type
+        const auto decode = [](const CompactEncoding::Type type, const auto code)
+        {
+            using Code = decltype(code);
+            return [type](const ROOT::VecOps::RVec<Code>& codes, const double& positionResolution,
+                          const double& logStep)
+            {
+                const auto encoding = CompactEncoding{positionResolution, logStep};
+                return ROOT::VecOps::Map(codes, [&](const Code code) { return encoding.decode(type, code); });
+            };
+        };
+
+        // 16 bit columns from the tree and rntuple backends, int from the g4 backend
+        const auto columnType = inputDF.GetColumnType("z");
+        if (columnType.find("short") != std::string::npos || columnType.find("int16") != std::string::npos)
+            data = data.Redefine("z", decode(CompactEncoding::kPosition, std::int16_t{}),
+                                 {"z", "positionResolution", "logStep"})
+                       .Redefine("t", decode(CompactEncoding::kTime, std::int16_t{}),
+                                 {"t", "positionResolution", "logStep"});
+        else
+            data = data.Redefine("z", decode(CompactEncoding::kPosition, int{}), {"z", "positionResolution", "logStep"})
+                       .Redefine("t", decode(CompactEncoding::kTime, int{}), {"t", "positionResolution", "logStep"});
+    }
 
     auto timeFilter = [&](const double& eventTime, const ROOT::VecOps::RVec<double>& time) -> ROOT::VecOps::RVec<bool>
     { return ((eventTime + time) > timeBegin) && ((eventTime + time) < timeEnd); };
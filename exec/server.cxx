@@ -0,0 +1,363 @@
+#include "ActionInitialization.h"
+#include "CLI11.hpp"
+#include "DetectorConstruction.h"
+#include "PhysicsList.h"
+#include "PhysicsTableCache.h"
+#include "RunAction.h"
+#include "RunManagerFactory.h"
+#include "Settings.h"
+
+#include <G4RunManager.hh>
+#include <G4ios.hh>
+#include <Randomize.hh>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+// Simulation daemon : initialises the run manager once, then runs the requests received on a UNIX socket, one JSON
+// object per line, e.g.
+//   {"particle": "carbon", "energy": 290, "events": 1000, "seed": 3, "material": "water", "width": 20,
+//    "directory": "plan7"}
+// Only particle, energy, events and seed are required. The material and width rebuild the geometry when they change,
+// the directory (relative to the one of the server) receives the output file. The server answers with one JSON line
+// per progress update, {"progress": <status>} with the status of RunMetrics, then {"result": {"file": ...}} or
+// {"error": "..."}. {"shutdown": true} stops the server. The output options are those of the server command line.
+
+namespace
+{
+namespace fs = std::filesystem;
+
+// "key": value pairs of a flat JSON object, strings unquoted
+std::map<std::string, std::string> readRequest(const std::string& line)
+{
+    static const std::regex pair{R"re("(\w+)"\s*:\s*(?:"([^"\\]*)"|([^,}\s]+)))re"};
+
+    std::map<std::string, std::string> values{};
+    for (auto it = std::sregex_iterator{line.begin(), line.end(), pair}; it != std::sregex_iterator{}; ++it)
+        values[(*it)[1]] = (*it)[2].matched ? (*it)[2].str() : (*it)[3].str();
+
+    return values;
+}
+
+std::string quoted(const std::string& text)
+{
+    std::string result = "\"";
+    for (const auto c : text)
+    {
+        if (c == '"' || c == '\\')
+            result += '\\';
+        result += c == '\n' ? ' ' : c;
+    }
+    return result + "\"";
+}
+
+class Connection
+{
+  public:
+    explicit Connection(const int socket)
+        : socket(socket)
+    {
+    }
+
+    ~Connection() { close(socket); }
+
+    // false at the end of the connection
+    bool readLine(std::string& line)
+    {
+        while (true)
+        {
+            const auto end = buffer.find('\n');
+            if (end != std::string::npos)
+            {
+                line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                return true;
+            }
+
+            char       chunk[4096];
+            const auto n = recv(socket, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+                return false;
+            buffer.append(chunk, n);
+        }
+    }
+
+    // from the main thread and the progress thread
+    void send(const std::string& message)
+    {
+        std::lock_guard<std::mutex> lock{sendMutex};
+
+        const auto line = message + "\n";
+        for (std::size_t sent = 0; sent < line.size();)
+        {
+            // a client gone is not an error of the run
+            const auto n = ::send(socket, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+            if (n <= 0)
+                return;
+            sent += n;
+        }
+    }
+
+  protected:
+    const int   socket;
+    std::string buffer{};
+    std::mutex  sendMutex{};
+};
+
+// forwards the status file written by RunMetrics to the client during a run
+class ProgressForwarder
+{
+  public:
+    ProgressForwarder(Connection& connection, const std::string& statusFile, const double interval)
+        : connection(connection)
+        , statusFile(statusFile + ".json")
+        , interval(interval)
+    {
+        thread = std::thread{&ProgressForwarder::loop, this};
+    }
+
+    ~ProgressForwarder()
+    {
+        {
+            std::lock_guard<std::mutex> lock{stopMutex};
+            stop = true;
+        }
+        stopCondition.notify_one();
+        thread.join();
+
+        // the final status, written at the end of the run
+        forward();
+    }
+
+  protected:
+    void loop()
+    {
+        std::unique_lock<std::mutex> lock{stopMutex};
+        while (!stopCondition.wait_for(lock, interval, [this] { return stop; }))
+            forward();
+    }
+
+    void forward()
+    {
+        std::ifstream file{statusFile};
+        if (!file)
+            return;
+
+        std::stringstream status{};
+        status << file.rdbuf();
+
+        auto text = status.str();
+        text.erase(std::remove(text.begin(), text.end(), '\n'), text.end());
+        if (text != lastStatus)
+            connection.send("{\"progress\": " + text + "}");
+        lastStatus = text;
+    }
+
+  protected:
+    Connection&                         connection;
+    const std::string                   statusFile;
+    const std::chrono::duration<double> interval;
+
+    std::string lastStatus{};
+
+    std::thread             thread{};
+    std::mutex              stopMutex{};
+    std::condition_variable stopCondition{};
+    bool                    stop = false;
+};
+} // namespace
+
+int main(int argc, char** argv)
+{
+    CLI::App app;
+
+    auto settings = Settings{};
+
+    std::string socketPath{};
+
+    app.add_option("--socket", socketPath, "path of the UNIX socket")->default_val("carbonTherapy.sock");
+    app.add_option("-t", settings.nThreads, "number of threads")->default_val(1);
+    app.add_option("--run-manager", settings.runManagerType, "serial, mt, tasking or tbb")->default_val("mt");
+    app.add_option("--eventModulo", settings.eventModulo,
+                   "mt/tasking : events per worker request or per task, 0 lets Geant4 choose")
+        ->default_val(0);
+    app.add_option("--affinity", settings.affinity,
+                   "pin the worker threads : compact, scatter or a comma separated list of CPUs (Linux)");
+    app.add_option("-m", settings.bodyMaterial, "initial body material : water of waterGel")->default_val("waterGel");
+    app.add_option("-b", settings.bodyWidth, "initial body width in cm")->default_val(15);
+    app.add_flag("--omitNeutrons", settings.omitNeutrons, "do note write neutrons in file");
+    app.add_flag("--beamTree", settings.beamTree, "write beam tree");
+    app.add_flag("--minimalTree", settings.minimalTreeForTransverseGammas,
+                 "produce a minimal tree with only info about transverse gammas");
+    app.add_option("--columns", settings.columns, "comma separated list of the only tree columns to write")
+        ->delimiter(',');
+    app.add_option("--drop-columns", settings.dropColumns, "comma separated list of tree columns not to write")
+        ->delimiter(',');
+    app.add_option("--physicsCache", settings.physicsCache,
+                   "directory where the physics tables are stored by a first run and retrieved by the next ones");
+    app.add_option("--statusInterval", settings.statusInterval, "progress report interval in s")
+        ->default_val(2)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--backend", settings.outputBackend, "output backend : g4, tree or rntuple")->default_val("g4");
+    app.add_option("--compression", settings.compressionAlgorithm, "tree/rntuple backend : zlib, lzma, lz4 or zstd")
+        ->default_val("zstd");
+    app.add_option("--compressionLevel", settings.compressionLevel, "tree/rntuple backend : compression level")
+        ->default_val(5);
+
+    CLI11_PARSE(app, argc, argv);
+
+    if (settings.minimalTreeForTransverseGammas)
+    {
+        settings.beamTree = false;
+        settings.omitNeutrons = true;
+    }
+
+    // the directories of the requests are relative to this one, the status file is read during the runs
+    const auto baseDirectory = fs::current_path();
+    settings.statusFile = (baseDirectory / (fs::path{socketPath}.filename().string() + ".status")).string();
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path))
+        throw std::logic_error("socket path too long : " + socketPath);
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    const auto server = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(socketPath.c_str()); // left by a previous server
+    if (server < 0 || bind(server, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+        || listen(server, 4) < 0)
+        throw std::runtime_error("cannot listen on " + socketPath + " : " + std::strerror(errno));
+
+    // the particle and energy are set by each request
+    ActionInitialization::checkSettings(settings);
+    RunManagerFactory::checkType(settings.runManagerType);
+
+    auto* runManager = RunManagerFactory::create(settings);
+
+    runManager->SetUserInitialization(new DetectorConstruction(settings));
+
+    auto phys = new PhysicsList;
+    runManager->SetUserInitialization(phys);
+
+    runManager->SetUserInitialization(new ActionInitialization(settings));
+
+    runManager->Initialize();
+
+    const auto physicsTableCache = PhysicsTableCache{settings.physicsCache, phys};
+    runManager->BeamOn(0);
+    physicsTableCache.store();
+
+    G4cout << "listening on " << socketPath << G4endl;
+
+    auto shutdown = false;
+    while (!shutdown)
+    {
+        const auto client = accept(server, nullptr, nullptr);
+        if (client < 0)
+            continue;
+
+        auto connection = Connection{client};
+
+        std::string line{};
+        while (!shutdown && connection.readLine(line))
+        {
+            const auto request = readRequest(line);
+
+            if (request.count("shutdown") && request.at("shutdown") == "true")
+            {
+                shutdown = true;
+                connection.send("{\"result\": \"shutdown\"}");
+                break;
+            }
+
+            // the settings of the previous request are restored if this one is rejected
+            const auto previousSettings = settings;
+
+            try
+            {
+                for (const auto key : {"particle", "energy", "events", "seed"})
+                {
+                    if (!request.count(key))
+                        throw std::logic_error(std::string{"missing "} + key);
+                }
+
+                settings.particleName = request.at("particle");
+                settings.beamMeanEnergy = std::stod(request.at("energy"));
+                settings.nEvents = std::stoi(request.at("events"));
+                settings.seed = std::stoi(request.at("seed"));
+                if (request.count("material"))
+                    settings.bodyMaterial = request.at("material");
+                if (request.count("width"))
+                    settings.bodyWidth = std::stod(request.at("width"));
+
+                ActionInitialization::checkSettings(settings);
+                if (settings.nEvents <= 0 || settings.bodyWidth < 0)
+                    throw std::logic_error("positive events and width please");
+
+                auto directory = baseDirectory;
+                if (request.count("directory"))
+                {
+                    directory /= request.at("directory");
+                    fs::create_directories(directory);
+                }
+
+                const auto geometryChanged = settings.bodyMaterial != previousSettings.bodyMaterial
+                                          || settings.bodyWidth != previousSettings.bodyWidth;
+                if (geometryChanged)
+                    runManager->ReinitializeGeometry(true);
+
+                // the workers are idle between the runs
+                fs::current_path(directory);
+
+                G4Random::setTheSeed(settings.seed + 2);
+
+                // so that the status of the previous run is not forwarded
+                std::error_code error{};
+                fs::remove(settings.statusFile + ".json", error);
+
+                const auto beginTime = std::chrono::steady_clock::now();
+                {
+                    const auto progress = ProgressForwarder{connection, settings.statusFile, settings.statusInterval};
+                    runManager->BeamOn(settings.nEvents);
+                }
+                const std::chrono::duration<double> runTime = std::chrono::steady_clock::now() - beginTime;
+
+                fs::current_path(baseDirectory);
+
+                const auto file = directory / (RunAction::makeRunName(settings) + ".root");
+
+                std::stringstream result{};
+                result << "{\"result\": {\"file\": " << quoted(file.string()) << ", \"events\": " << settings.nEvents
+                       << ", \"seconds\": " << runTime.count() << "}}";
+                connection.send(result.str());
+            }
+            catch (const std::exception& exception)
+            {
+                settings = previousSettings;
+                fs::current_path(baseDirectory);
+                connection.send("{\"error\": " + quoted(exception.what()) + "}");
+            }
+        }
+    }
+
+    close(server);
+    unlink(socketPath.c_str());
+
+    delete runManager;
+}
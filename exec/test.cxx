@@ -1,14 +1,23 @@
 #include "ActionInitialization.h"
 #include "CLI11.hpp"
 #include "DetectorConstruction.h"
+#include "ForkedProcesses.h"
+#include "OutputBackend.h"
+#include "OutputMerger.h"
 #include "PhysicsList.h"
+#include "PhysicsTableCache.h"
+#include "RunAction.h"
+#include "RunManagerFactory.h"
 #include "Settings.h"
+#include "ThreadPlacement.h"
 
 #include <CLHEP/Units/SystemOfUnits.h>
 
-#include <G4RunManagerFactory.hh>
+#include <G4RunManager.hh>
 #include <G4SteppingVerbose.hh>
+#include <Randomize.hh>
 #include <G4UImanager.hh>
+#include <G4ios.hh>
 
 #include <G4DecayPhysics.hh>
 #include <G4PhysListFactory.hh>
@@ -18,23 +27,99 @@
 #include <G4VisExecutive.hh>
 #include <QGSP_BIC_HP.hh>
 
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
 int main(int argc, char** argv)
 {
     CLI::App app;
 
     auto settings = Settings{};
 
-    app.add_option("-N", settings.particleName, "name of the beam particle : proton or carbon")->required();
-    app.add_option("-e", settings.beamMeanEnergy, "beam energy in MeV")->required();
+    // every combination is run in turn, with one output file each
+    std::vector<G4String> particleNames{};
+    std::vector<G4double> beamEnergies{};
+    std::vector<G4String> bodyMaterials{};
+    std::vector<G4double> bodyWidths{};
+
+    app.add_option("-N", particleNames, "name of the beam particle : proton or carbon, or a comma separated list")
+        ->required()
+        ->delimiter(',');
+    app.add_option("-e", beamEnergies, "beam energy in MeV, or a comma separated list")->required()->delimiter(',');
     app.add_option("-s", settings.seed, "seed")->required();
     app.add_option("-n", settings.nEvents, "number of events")->required();
-    app.add_option("-m", settings.bodyMaterial, "body material : water of waterGel")->default_val("waterGel");
-    app.add_option("-b", settings.bodyWidth, "body width in cm")->default_val(15);
+    app.add_option("-m", bodyMaterials, "body material : water of waterGel, or a comma separated list")
+        ->default_val("waterGel")
+        ->delimiter(',');
+    app.add_option("-b", bodyWidths, "body width in cm, or a comma separated list")->default_val(15)->delimiter(',');
     app.add_option("-t", settings.nThreads, "number of threads")->default_val(1);
+    app.add_option("--run-manager", settings.runManagerType, "serial, mt, tasking or tbb")->default_val("mt");
+    app.add_option("--eventModulo", settings.eventModulo,
+                   "mt/tasking : events per worker request or per task, 0 lets Geant4 choose")
+        ->default_val(0);
+    app.add_option("--affinity", settings.affinity,
+                   "pin the worker threads, or the processes of --processes : compact, scatter or a comma separated "
+                   "list of CPUs (Linux)");
     app.add_flag("--omitNeutrons", settings.omitNeutrons, "do note write neutrons in file");
     app.add_flag("--beamTree", settings.beamTree, "write beam tree");
     app.add_flag("--minimalTree", settings.minimalTreeForTransverseGammas,
                  "produce a minimal tree with only info about transverse gammas");
+    app.add_option("--columns", settings.columns, "comma separated list of the only tree columns to write")
+        ->delimiter(',');
+    app.add_option("--drop-columns", settings.dropColumns, "comma separated list of tree columns not to write")
+        ->delimiter(',');
+    app.add_flag("--escapingHistos", settings.escapingHistograms,
+                 "histograms of the escaping particles per species instead of tree columns");
+    app.add_flag("--nucleiMap", settings.nucleiMap,
+                 "count the produced nuclei per A, Z, depth and radius instead of writing tree entries");
+    app.add_option("--nucleiKeep", settings.nucleiKeep,
+                   "comma separated Z:A isotopes still written in the tree, implies --nucleiMap")
+        ->delimiter(',');
+    app.add_option("--activityWindows", settings.activityWindows,
+                   "comma separated begin:end time windows (min) after the irradiation of the activity depth profiles")
+        ->delimiter(',');
+    app.add_option("--irradiationTime", settings.irradiationTime, "irradiation time (min) of the activity profiles")
+        ->default_val(0);
+    app.add_flag("--eventStats", settings.eventStats, "write the wall time, step and track counts of each event");
+    app.add_flag("--profileProcesses", settings.profileProcesses,
+                 "print the CPU time per particle, process and region at the end of the run");
+    app.add_flag("--perfCounters", settings.perfCounters, "report the hardware counters of the workers (Linux)");
+    app.add_option("--physicsCache", settings.physicsCache,
+                   "directory where the physics tables are stored by a first run and retrieved by the next ones");
+    app.add_option("--status", settings.statusFile, "write the run progress in <status>.json and <status>.prom");
+    app.add_option("--statusInterval", settings.statusInterval, "progress report interval in s")
+        ->default_val(2)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--trigger", settings.triggers,
+                   "only write the events passing all these predicates : gammas:N[:thetaMin:thetaMax], emitters:N, "
+                   "emitter:Z:A")
+        ->delimiter(',');
+    app.add_flag("--compact", settings.compactTree, "store positions, energies, times and angles as 16 bit codes");
+    app.add_option("--positionResolution", settings.positionResolution, "position resolution of the compact tree in mm")
+        ->default_val(0.1)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--logStep", settings.logStep, "relative energy and time step of the compact tree")
+        ->default_val(1e-3)
+        ->check(CLI::PositiveNumber);
+    app.add_option("--backend", settings.outputBackend, "output backend : g4, tree or rntuple")->default_val("g4");
+    app.add_option("--compression", settings.compressionAlgorithm, "tree/rntuple backend : zlib, lzma, lz4 or zstd")
+        ->default_val("zstd");
+    app.add_option("--compressionLevel", settings.compressionLevel, "tree/rntuple backend : compression level")
+        ->default_val(5);
+    app.add_option("--basketSize", settings.basketSize, "tree backend : basket size in bytes")->default_val(32000);
+    app.add_option("--autoFlush", settings.autoFlush, "tree backend : auto flush, entries if > 0, bytes if < 0")
+        ->default_val(-30000000);
+    app.add_flag("--async", settings.asyncOutput, "tree/rntuple backend : fill the output from a writer thread");
+    app.add_option("--asyncQueueDepth", settings.asyncQueueDepth, "number of event buffers per worker")
+        ->default_val(16)
+        ->check(CLI::PositiveNumber);
+    app.add_flag("--perWorkerFiles", settings.perWorkerFiles, "tree/rntuple backend : one output file per thread");
+    app.add_option("--processes", settings.nProcesses,
+                   "run the events in this many processes forked after the initialisation instead of threads");
 
     CLI11_PARSE(app, argc, argv);
 
@@ -44,24 +129,181 @@ int main(int argc, char** argv)
         settings.omitNeutrons = true;
     }
 
+    // the kept isotopes are the exceptions of the map
+    if (!settings.nucleiKeep.empty())
+        settings.nucleiMap = true;
+
+    struct ScanPoint
+    {
+        G4String bodyMaterial{};
+        G4double bodyWidth{};
+        G4String particleName{};
+        G4double beamMeanEnergy{};
+    };
+
+    // the geometry changes the least often
+    std::vector<ScanPoint> scanPoints{};
+    for (const auto& bodyMaterial : bodyMaterials)
+        for (const auto bodyWidth : bodyWidths)
+            for (const auto& particleName : particleNames)
+                for (const auto beamMeanEnergy : beamEnergies)
+                    scanPoints.push_back({bodyMaterial, bodyWidth, particleName, beamMeanEnergy});
+
+    const auto setScanPoint = [&](const ScanPoint& point)
+    {
+        settings.bodyMaterial = point.bodyMaterial;
+        settings.bodyWidth = point.bodyWidth;
+        settings.particleName = point.particleName;
+        settings.beamMeanEnergy = point.beamMeanEnergy;
+    };
+
+    // before any initialisation
+    for (const auto& point : scanPoints)
+    {
+        setScanPoint(point);
+        ActionInitialization::checkSettings(settings);
+    }
+
+    // the run manager is initialised with the first point
+    setScanPoint(scanPoints.front());
+
     G4Random::setTheSeed(settings.seed + 2);
 
-    auto* runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::MT);
-    // auto* runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::SerialOnly);
-    runManager->SetNumberOfThreads(settings.nThreads);
+    // a process without events would run a fake run, which writes no output to merge
+    if (settings.nProcesses > settings.nEvents)
+    {
+        G4cout << "--processes reduced to the number of events, " << settings.nEvents << G4endl;
+        settings.nProcesses = std::max(settings.nEvents, 0);
+    }
+
+    // a forked process only has the thread that called fork
+    const auto forkProcesses = settings.nProcesses > 0;
+    if (forkProcesses && settings.runManagerType != "serial")
+    {
+        G4cout << "--processes uses the serial run manager, each process runs on its own thread" << G4endl;
+        settings.runManagerType = "serial";
+    }
+
+    auto* runManager = RunManagerFactory::create(settings);
 
     runManager->SetUserInitialization(new DetectorConstruction(settings));
 
     // G4VModularPhysicsList* phys = new QGSP_BIC_HP;
-    G4VModularPhysicsList* phys = new PhysicsList;
+    auto phys = new PhysicsList;
     // phys->RegisterPhysics(new G4RadioactiveDecayPhysics);
     runManager->SetUserInitialization(phys);
 
     // User action initialization
     runManager->SetUserInitialization(new ActionInitialization(settings));
 
+    const auto initBegin = std::chrono::steady_clock::now();
+
     runManager->Initialize();
-    runManager->BeamOn(settings.nEvents);
+
+    const auto tablesBegin = std::chrono::steady_clock::now();
+
+    // without events, only builds or retrieves the physics tables
+    const auto physicsTableCache = PhysicsTableCache{settings.physicsCache, phys};
+    runManager->BeamOn(0);
+    physicsTableCache.store();
+
+    const auto                          initEnd = std::chrono::steady_clock::now();
+    const std::chrono::duration<double> initTime = initEnd - initBegin;
+    const std::chrono::duration<double> tablesTime = initEnd - tablesBegin;
+
+    G4cout << "initialisation : " << initTime.count() << " s, of which physics tables " << tablesTime.count()
+           << " s (" << (physicsTableCache.isRetrieved() ? "retrieved" : "built") << ")" << G4endl;
+
+    auto nEvents = settings.nEvents;
+    auto seed = settings.seed + 2;
+
+    // one file per scan point from the <run>_p<i>.root files of the processes, which are kept if the merge fails
+    const auto mergeProcessOutputs = [&]
+    {
+        const auto compression =
+            OutputBackend::compressionSettings(settings.compressionAlgorithm, settings.compressionLevel);
+        const auto merger = OutputMerger{settings.nProcesses, compression};
+
+        auto success = true;
+        for (const auto& point : scanPoints)
+        {
+            setScanPoint(point);
+            const auto runName = RunAction::makeRunName(settings);
+
+            auto                     processSettings = settings;
+            std::vector<std::string> inputs{};
+            for (auto i = 0; i < settings.nProcesses; ++i)
+            {
+                processSettings.processIndex = i;
+                inputs.push_back(RunAction::makeRunName(processSettings) + ".root");
+            }
+
+            if (!merger.merge(inputs, runName + ".root"))
+            {
+                G4cout << "failed to merge the process outputs into " << runName << ".root" << G4endl;
+                success = false;
+                continue;
+            }
+
+            for (const auto& input : inputs)
+                std::filesystem::remove(input);
+        }
+
+        return success;
+    };
+
+    // the geometry and the physics tables are shared copy-on-write with the children
+    if (forkProcesses)
+    {
+        auto processes = ForkedProcesses{settings.nProcesses, settings.nEvents};
+
+        // checked by the parent, the processes are pinned instead of the threads
+        const auto processPlacement =
+            settings.affinity.empty() ? nullptr : std::make_unique<ThreadPlacement>(settings.affinity);
+
+        // drawn like the seeds of the MT workers
+        std::vector<long> processSeeds{};
+        for (auto i = 0; i < settings.nProcesses; ++i)
+            processSeeds.push_back(static_cast<long>(100000000L * G4UniformRand()));
+
+        settings.processIndex = processes.start();
+
+        if (settings.processIndex < 0)
+        {
+            const auto success = processes.wait() && mergeProcessOutputs();
+            delete runManager;
+            return success ? 0 : 1;
+        }
+
+        nEvents = processes.getNumberOfEvents(settings.processIndex);
+        seed = processSeeds[settings.processIndex];
+        settings.firstEvent = processes.getFirstEvent(settings.processIndex);
+        if (!settings.statusFile.empty())
+            settings.statusFile += "_p" + std::to_string(settings.processIndex);
+
+        // after the fork, so that each process gets its own CPU
+        if (processPlacement)
+            processPlacement->pin(settings.processIndex);
+    }
+
+    // the actions and the detector construction read the settings at each run
+    for (const auto& point : scanPoints)
+    {
+        const auto geometryChanged =
+            point.bodyMaterial != settings.bodyMaterial || point.bodyWidth != settings.bodyWidth;
+
+        setScanPoint(point);
+
+        // rebuilt by the next BeamOn, the workers take it from the master; the physics tables are only rebuilt for new
+        // materials
+        if (geometryChanged)
+            runManager->ReinitializeGeometry(true);
+
+        // each point as if it were run alone
+        G4Random::setTheSeed(seed);
+
+        runManager->BeamOn(nEvents);
+    }
 
     delete runManager;
 }
@@ -2,10 +2,12 @@
 #include "CLI11.hpp"
 #include "DetectorConstruction.h"
 #include "PhysicsList.h"
+#include "RunManagerFactory.h"
 
-#include <G4RunManagerFactory.hh>
+#include <G4RunManager.hh>
 #include <G4SteppingVerbose.hh>
 #include <G4UImanager.hh>
+#include <Randomize.hh>
 
 #include <G4DecayPhysics.hh>
 #include <G4PhysListFactory.hh>
@@ -34,7 +36,8 @@ int main(int argc, char** argv)
     // app.add_option("-n", nEvents, "number of events")->required();
     app.add_option("-m", settings.bodyMaterial, "body material : water of waterGel")->default_val("waterGel");
     app.add_option("-b", settings.bodyWidth, "body width in cm")->default_val(10);
-    // app.add_option("-t", nThreads, "number of threads")->default_val(1);
+    app.add_option("-t", settings.nThreads, "number of threads")->default_val(1);
+    app.add_option("--run-manager", settings.runManagerType, "serial, mt, tasking or tbb")->default_val("serial");
 
     CLI11_PARSE(app, argc, argv);
 
@@ -42,8 +45,7 @@ int main(int argc, char** argv)
 
     G4Random::setTheSeed(settings.seed + 2);
 
-    auto* runManager = G4RunManagerFactory::CreateRunManager(G4RunManagerType::SerialOnly);
-    // runManager->SetNumberOfThreads(nThreads);
+    auto* runManager = RunManagerFactory::create(settings);
 
     runManager->SetUserInitialization(new DetectorConstruction(settings));
 
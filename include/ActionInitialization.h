@@ -5,16 +5,25 @@
 #include <globals.hh>
 
 #include "Settings.h"
+#include "ThreadPlacement.h"
+
+#include <memory>
 
 class ActionInitialization : public G4VUserActionInitialization
 {
   public:
+    // the actions read the beam and body settings at each run, they may change between runs
     ActionInitialization(const Settings& settings);
     ~ActionInitialization() = default;
 
     void BuildForMaster() const override;
     void Build() const override;
 
+    // throws if the beam or body settings are not supported
+    static void checkSettings(const Settings& settings);
+
   protected:
-    Settings settings{};
+    const Settings& settings;
+
+    std::unique_ptr<ThreadPlacement> threadPlacement = nullptr; // --affinity
 };
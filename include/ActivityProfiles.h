@@ -0,0 +1,44 @@
+#pragma once
+
+#include <G4Types.hh>
+
+#include <string>
+#include <vector>
+
+class RunSummary;
+class TH1D;
+
+// Depth profiles of the positron emitter decays (15O, 11C, 13N and all of them) measured in time windows after
+// the end of the irradiation, built during the simulation instead of from the tree by plotActivity.
+// As in plotActivity, the events are spread uniformly over the irradiation, the last one at the end of it.
+class ActivityProfiles
+{
+  public:
+    // windows : "begin:end" in minutes after the end of the irradiation
+    ActivityProfiles(const std::vector<std::string>& windows, const G4double irradiationTime, const G4int nEvents);
+
+    G4bool isEnabled() const { return !windows.empty(); }
+
+    void book(RunSummary& summary);
+
+    void beginEvent(const G4int eventID);
+
+    // time of the decay since the beginning of the event, in Geant4 units
+    void add(const G4int A, const G4int Z, const G4double depth, const G4double time);
+
+  protected:
+    struct Window
+    {
+        G4double begin;
+        G4double end;
+
+        // 15O, 11C, 13N, sum, owned by the summary
+        std::vector<TH1D*> histos{};
+    };
+
+    std::vector<Window> windows{};
+
+    G4double irradiationTime = 0;
+    G4int    nEvents = 0;
+    G4double eventTime = 0; // <= 0, relative to the end of the irradiation
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+// Heap allocation accounting, compiled only with the WITH_ALLOCATION_COUNTING CMake option, which replaces the global
+// operator new and delete. Each allocation is charged to the user action of the enclosing ALLOCATION_SCOPE(category)
+// of its thread, or to Geant4 outside of them. ALLOCATION_BEGIN_RUN() and ALLOCATION_END_EVENT() delimit the events
+// of the calling thread, ALLOCATION_REPORT() prints the allocations and bytes per event of all the threads and
+// resets them.
+
+#ifdef WITH_ALLOCATION_COUNTING
+
+namespace AllocationCounter
+{
+enum Category
+{
+    kGeant4,
+    kStepping,
+    kTracking,
+    kEvent,
+    kWriter,
+    nCategories
+};
+
+Category setCategory(const Category category); // returns the previous one
+
+// the allocations between the beginning of the run and the end of the first event are charged to it
+void beginRun();
+void endEvent();
+
+void report();
+
+class Scope
+{
+  public:
+    explicit Scope(const Category category)
+        : previous(setCategory(category))
+    {
+    }
+
+    ~Scope() { setCategory(previous); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  protected:
+    const Category previous;
+};
+} // namespace AllocationCounter
+
+#define ALLOCATION_CONCAT_IMPL(a, b) a##b
+#define ALLOCATION_CONCAT(a, b) ALLOCATION_CONCAT_IMPL(a, b)
+#define ALLOCATION_SCOPE(category) \
+    const AllocationCounter::Scope ALLOCATION_CONCAT(allocationScope, __LINE__){AllocationCounter::k##category}
+#define ALLOCATION_BEGIN_RUN() AllocationCounter::beginRun()
+#define ALLOCATION_END_EVENT() AllocationCounter::endEvent()
+#define ALLOCATION_REPORT() AllocationCounter::report()
+
+#else
+
+#define ALLOCATION_SCOPE(category)
+#define ALLOCATION_BEGIN_RUN() static_cast<void>(0)
+#define ALLOCATION_END_EVENT() static_cast<void>(0)
+#define ALLOCATION_REPORT() static_cast<void>(0)
+
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "EventRecord.h"
+#include "OutputBackend.h"
+#include "SpscQueue.h"
+
+#include <G4Types.hh>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Moves the filling of another backend to a dedicated writer thread shared by all the workers.
+// At each event the worker swaps its record with a free buffer and hands the buffer over through a lock-free queue,
+// the writer thread swaps it into the record bound to the wrapped backend, fills it and gives the buffer back.
+// The buffers keep their capacity, so nothing is allocated in steady state.
+// The wrapped backend must not rely on G4 thread-local state (tree and rntuple backends only).
+class AsyncBackend : public OutputBackend
+{
+  public:
+    AsyncBackend(std::unique_ptr<OutputBackend> backend,
+                 const G4bool                   isMaster,
+                 const G4bool                   isWorker,
+                 const std::size_t              queueDepth);
+
+    void open(const std::string& fileName, EventRecord& record) override;
+    void fill() override;
+    void close() override;
+
+  protected:
+    // writer thread side, false if nothing was waiting
+    G4bool writePending();
+
+    static void startWriterThread();
+    static void stopWriterThread();
+    static void writerLoop();
+
+  protected:
+    std::unique_ptr<OutputBackend> backend = nullptr;
+
+    G4bool isMaster = false;
+    G4bool isWorker = false;
+
+    EventRecord* record = nullptr; // filled by the worker
+    EventRecord  boundRecord{};    // read by the wrapped backend
+
+    std::vector<std::unique_ptr<EventRecord>> buffers{};
+
+    SpscQueue<EventRecord*> filledBuffers; // worker -> writer thread
+    SpscQueue<EventRecord*> freeBuffers;   // writer thread -> worker
+
+    std::atomic<G4int> nPending{};
+    G4long             nStalls{}; // events for which the worker had to wait for a free buffer
+
+    static std::thread                writerThread;
+    static std::atomic<G4bool>        stopWriter;
+    static std::mutex                 writerThreadMutex;
+    static G4int                      nWriterThreadUsers;
+    static std::mutex                 backendsMutex;
+    static std::vector<AsyncBackend*> backends;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// 16 bit codes used by the compact tree :
+// - positions are fixed point with a given resolution (mm)
+// - energies (MeV) and times (s) are log quantised with a given relative step around a reference value
+// - angles (rad) are quantised over [-pi, pi]
+// It does not depend on Geant4 so that the analysis executables can decode the files
+class CompactEncoding
+{
+  public:
+    enum Type
+    {
+        kNone,
+        kPosition,
+        kEnergy,
+        kTime,
+        kAngle
+    };
+
+    static constexpr double energyReference = 1;  // MeV
+    static constexpr double timeReference = 1e-9; // s
+
+    static constexpr std::int32_t maxCode = std::numeric_limits<std::int16_t>::max();
+    static constexpr std::int32_t zeroCode = std::numeric_limits<std::int16_t>::min(); // log codes only
+
+    static constexpr double angleStep = 3.14159265358979323846 / maxCode; // rad
+
+  public:
+    CompactEncoding(const double positionResolution, const double logStep)
+        : positionResolution(positionResolution)
+        , logStep(logStep)
+    {
+    }
+
+    std::int16_t encode(const Type type, const double value) const
+    {
+        switch (type)
+        {
+        case kPosition:
+            return clamp(value / positionResolution);
+        case kEnergy:
+            return encodeLog(value, energyReference);
+        case kTime:
+            return encodeLog(value, timeReference);
+        case kAngle:
+            return clamp(value / angleStep);
+        default:
+            return clamp(value);
+        }
+    }
+
+    double decode(const Type type, const std::int32_t code) const
+    {
+        switch (type)
+        {
+        case kPosition:
+            return code * positionResolution;
+        case kEnergy:
+            return decodeLog(code, energyReference);
+        case kTime:
+            return decodeLog(code, timeReference);
+        case kAngle:
+            return code * angleStep;
+        default:
+            return code;
+        }
+    }
+
+  protected:
+    static std::int16_t clamp(const double code)
+    {
+        const auto rounded = std::lround(code);
+        if (rounded > maxCode)
+            return maxCode;
+        if (rounded < -maxCode)
+            return -maxCode;
+        return static_cast<std::int16_t>(rounded);
+    }
+
+    // values <= 0 get a dedicated code since the log is not defined
+    std::int16_t encodeLog(const double value, const double reference) const
+    {
+        if (value <= 0)
+            return zeroCode;
+        return clamp(std::log(value / reference) / logStep);
+    }
+
+    double decodeLog(const std::int32_t code, const double reference) const
+    {
+        if (code == zeroCode)
+            return 0;
+        return reference * std::exp(code * logStep);
+    }
+
+  public:
+    const double positionResolution;
+    const double logStep;
+};
@@ -17,12 +17,15 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     };
 
   public:
+    // the body material and width are read at each construction, they may change between runs
     DetectorConstruction(const Settings& settings);
     ~DetectorConstruction() = default;
 
     G4VPhysicalVolume* Construct() override;
 
   protected:
+    const Settings& settings;
+
     BodyMaterial bodyMaterialType = kWaterGel;
     G4double     bodyWidth{};
 };
\ No newline at end of file
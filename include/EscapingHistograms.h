@@ -0,0 +1,47 @@
+#pragma once
+
+#include <G4Types.hh>
+
+#include <array>
+
+class RunSummary;
+class TH1D;
+
+// Distributions of the particles escaping the body, per species, filled instead of the escaping tree columns so
+// that the output size does not depend on the number of events. Booked in the RunSummary of each thread and
+// merged at the end of the run.
+class EscapingHistograms
+{
+  public:
+    void book(RunSummary& summary);
+
+    // in Geant4 units
+    void fill(const G4int    pdg,
+              const G4double energy,
+              const G4double theta,
+              const G4double phi,
+              const G4double exitZ,
+              const G4double originZ);
+
+  protected:
+    struct Species
+    {
+        const char* name;
+        G4int       pdg; // 0 for everything else
+
+        TH1D* energy = nullptr; // owned by the summary
+        TH1D* theta = nullptr;
+        TH1D* phi = nullptr;
+        TH1D* exitZ = nullptr;
+        TH1D* originZ = nullptr;
+    };
+
+    std::array<Species, 6> species = {{
+        {"gamma", 22},
+        {"neutron", 2112},
+        {"proton", 2212},
+        {"electron", 11},
+        {"positron", -11},
+        {"other", 0},
+    }};
+};
@@ -5,7 +5,9 @@
 #include <G4UserEventAction.hh>
 #include <globals.hh>
 
-#include <atomic>
+#include "RunMetrics.h"
+
+#include <chrono>
 
 class G4Event;
 class G4Track;
@@ -20,14 +22,13 @@ class EventAction : public G4UserEventAction
     void BeginOfEventAction(const G4Event* event) override;
     void EndOfEventAction(const G4Event* event) override;
 
-    static G4int getNEventsProcessed() { return nEventsProcessed; }
-    static void  setNEventsProcessed() { nEventsProcessed = 0; }
-
   protected:
     RootWriter*     rootWriter = nullptr;
     TrackingAction* trackingAction = nullptr;
 
     G4int nEventsElapsed{};
 
-    static std::atomic<G4int> nEventsProcessed;
+    RunMetrics::Counters& metrics;
+
+    std::chrono::steady_clock::time_point eventBeginTime{};
 };
\ No newline at end of file
@@ -0,0 +1,361 @@
+#pragma once
+
+#include <CLHEP/Units/SystemOfUnits.h>
+#include <G4Types.hh>
+
+#include "CompactEncoding.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Single declaration of the output tree schema, in tree order.
+// X(kind, type, name, unit, group, encoding) : kind is Scalar (one value per event) or Vector (one entry per
+// particle), values given to set()/add() are divided by unit before being stored, encoding is the 16 bit code
+// used for vector columns in the compact tree. Scalar columns are always written at full precision, their encoding
+// is None.
+#define EVENT_RECORD_COLUMNS(X)                                  \
+    X(Scalar, int, eventID, 1., Event, None)                     \
+    X(Scalar, float, primaryEndX, CLHEP::mm, Event, None)        \
+    X(Scalar, float, primaryEndY, CLHEP::mm, Event, None)        \
+    X(Scalar, float, primaryEndZ, CLHEP::mm, Event, None)        \
+    X(Vector, int, A, 1., PositronEmitter, None)                 \
+    X(Vector, int, Z, 1., PositronEmitter, None)                 \
+    X(Vector, float, x, CLHEP::mm, PositronEmitter, Position)    \
+    X(Vector, float, y, CLHEP::mm, PositronEmitter, Position)    \
+    X(Vector, float, z, CLHEP::mm, PositronEmitter, Position)    \
+    X(Vector, float, t, CLHEP::s, PositronEmitter, Time)         \
+    X(Vector, int, nucleiA, 1., Nuclei, None)                    \
+    X(Vector, int, nucleiZ, 1., Nuclei, None)                    \
+    X(Vector, float, nucleiXPos, CLHEP::mm, Nuclei, Position)    \
+    X(Vector, float, nucleiYPos, CLHEP::mm, Nuclei, Position)    \
+    X(Vector, float, nucleiZPos, CLHEP::mm, Nuclei, Position)    \
+    X(Vector, int, pdgEsc, 1., Escaping, None)                   \
+    X(Vector, float, xEsc, CLHEP::mm, Escaping, Position)        \
+    X(Vector, float, yEsc, CLHEP::mm, Escaping, Position)        \
+    X(Vector, float, zEsc, CLHEP::mm, Escaping, Position)        \
+    X(Vector, float, thetaEsc, CLHEP::rad, Escaping, Angle)      \
+    X(Vector, float, phiEsc, CLHEP::rad, Escaping, Angle)        \
+    X(Vector, float, eEsc, CLHEP::MeV, Escaping, Energy)         \
+    X(Vector, float, timeEsc, CLHEP::s, Escaping, Time)          \
+    X(Vector, float, initialXEsc, CLHEP::mm, Escaping, Position) \
+    X(Vector, float, initialYEsc, CLHEP::mm, Escaping, Position) \
+    X(Vector, float, initialZEsc, CLHEP::mm, Escaping, Position) \
+    X(Scalar, float, beamX, CLHEP::mm, Beam, None)               \
+    X(Scalar, float, beamY, CLHEP::mm, Beam, None)               \
+    X(Scalar, float, beamZ, CLHEP::mm, Beam, None)               \
+    X(Scalar, float, beamPX, 1., Beam, None)                     \
+    X(Scalar, float, beamPY, 1., Beam, None)                     \
+    X(Scalar, float, beamPZ, 1., Beam, None)                     \
+    X(Scalar, float, beamE, CLHEP::MeV, Beam, None)              \
+    X(Scalar, float, wallTime, 1e-3, EventStats, None)           \
+    X(Scalar, int, nSteps, 1., EventStats, None)                 \
+    X(Scalar, int, nTracks, 1., EventStats, None)                \
+    X(Scalar, int, nGammas, 1., EventStats, None)                \
+    X(Scalar, int, nElectrons, 1., EventStats, None)             \
+    X(Scalar, int, nNeutrons, 1., EventStats, None)              \
+    X(Scalar, int, nProtons, 1., EventStats, None)               \
+    X(Scalar, int, nIons, 1., EventStats, None)                  \
+    X(Scalar, int, nOthers, 1., EventStats, None)                \
+    X(Scalar, int, peakStack, 1., EventStats, None)              \
+    X(Scalar, double, positionResolution, 1., Encoding, None)    \
+    X(Scalar, double, logStep, 1., Encoding, None)
+
+enum class ColumnGroup
+{
+    Event,
+    PositronEmitter,
+    Nuclei,
+    Escaping,
+    Beam,
+    EventStats, // cost of the event (wall time in ms), see EventStats
+    Encoding // parameters of the compact tree, constant per row so that decoding still works after merging files
+};
+
+template <typename T>
+struct ScalarColumn
+{
+    using value_type = T;
+    static constexpr bool isVector = false;
+
+    // scalars are never encoded
+    ScalarColumn(const char* name, const G4double unit, const ColumnGroup group, const CompactEncoding::Type)
+        : name(name)
+        , unit(unit)
+        , group(group)
+    {
+    }
+
+    template <typename V>
+    void set(const V quantity)
+    {
+        value = static_cast<T>(quantity / unit);
+    }
+
+    void clear() { value = T{}; }
+
+    void swap(ScalarColumn& other) { std::swap(value, other.value); }
+    void copyLayout(const ScalarColumn& other) { enabled = other.enabled; }
+
+    const char* const name;
+    const G4double    unit;
+    const ColumnGroup group;
+
+    G4bool enabled = true;
+    G4int  id = -1; // ntuple column id, assigned at registration
+
+    T value{};
+};
+
+template <typename T>
+struct VectorColumn
+{
+    using value_type = T;
+    static constexpr bool isVector = true;
+
+    VectorColumn(const char* name, const G4double unit, const ColumnGroup group, const CompactEncoding::Type encoding)
+        : name(name)
+        , unit(unit)
+        , group(group)
+        , encoding(encoding)
+    {
+    }
+
+    template <typename V>
+    void add(const V quantity)
+    {
+        if (enabled || kept)
+            data.push_back(static_cast<T>(quantity / unit));
+    }
+
+    // keeps the capacity, only remembers the largest event seen so far
+    void clear()
+    {
+        highWaterMark = std::max(highWaterMark, data.size());
+        data.clear();
+    }
+
+    void reserve(const std::size_t minCapacity) { data.reserve(std::max(highWaterMark, minCapacity)); }
+
+    void swap(VectorColumn& other)
+    {
+        data.swap(other.data);
+        codes.swap(other.codes);
+    }
+
+    void copyLayout(const VectorColumn& other)
+    {
+        enabled = other.enabled;
+        kept = other.kept;
+        compact = other.compact;
+    }
+
+    const char* const           name;
+    const G4double              unit;
+    const ColumnGroup           group;
+    const CompactEncoding::Type encoding;
+
+    G4bool enabled = true;
+    G4bool kept = false; // filled although not written, for the triggers
+    G4int  id = -1;
+
+    std::vector<T> data{};
+    std::size_t    highWaterMark{};
+
+    G4bool                    compact = false; // written as codes instead of data
+    std::vector<std::int16_t> codes{};         // filled from data at write time
+    std::vector<int>          intCodes{};      // copy of the codes for the G4 ntuples, which have no 16 bit columns
+};
+
+class EventRecord
+{
+  public:
+    EventRecord() = default;
+
+    // the G4 ntuple columns keep references to the vectors
+    EventRecord(const EventRecord&) = delete;
+    EventRecord& operator=(const EventRecord&) = delete;
+
+    template <typename F>
+    void forEachColumn(F&& f)
+    {
+#define EVENT_RECORD_VISIT(kind, type, name, unit, group, encoding) f(name);
+        EVENT_RECORD_COLUMNS(EVENT_RECORD_VISIT)
+#undef EVENT_RECORD_VISIT
+    }
+
+    template <typename F>
+    void forEachColumn(F&& f) const
+    {
+#define EVENT_RECORD_VISIT(kind, type, name, unit, group, encoding) f(name);
+        EVENT_RECORD_COLUMNS(EVENT_RECORD_VISIT)
+#undef EVENT_RECORD_VISIT
+    }
+
+    void clear()
+    {
+        forEachColumn([](auto& column) { column.clear(); });
+    }
+
+    // exchanges the content but not the layout, the buffers keep their capacity
+    void swap(EventRecord& other)
+    {
+#define EVENT_RECORD_SWAP(kind, type, name, unit, group, encoding) name.swap(other.name);
+        EVENT_RECORD_COLUMNS(EVENT_RECORD_SWAP)
+#undef EVENT_RECORD_SWAP
+    }
+
+    // enabled and compact columns
+    void copyLayout(const EventRecord& other)
+    {
+#define EVENT_RECORD_COPY_LAYOUT(kind, type, name, unit, group, encoding) name.copyLayout(other.name);
+        EVENT_RECORD_COLUMNS(EVENT_RECORD_COPY_LAYOUT)
+#undef EVENT_RECORD_COPY_LAYOUT
+    }
+
+    void reserve(const std::size_t minCapacity = 0)
+    {
+        forEachColumn(
+            [=](auto& column)
+            {
+                if constexpr (std::decay_t<decltype(column)>::isVector)
+                    column.reserve(minCapacity);
+            });
+    }
+
+    void setAllEnabled(const G4bool enabled)
+    {
+        forEachColumn([=](auto& column) { column.enabled = enabled; });
+    }
+
+    // returns false if no column has this name
+    G4bool setColumnEnabled(const std::string& name, const G4bool enabled)
+    {
+        G4bool found = false;
+        forEachColumn(
+            [&](auto& column)
+            {
+                if (name == column.name)
+                {
+                    column.enabled = enabled;
+                    found = true;
+                }
+            });
+        return found;
+    }
+
+    void setGroupEnabled(const ColumnGroup group, const G4bool enabled)
+    {
+        forEachColumn(
+            [=](auto& column)
+            {
+                if (column.group == group)
+                    column.enabled = enabled;
+            });
+    }
+
+    G4bool isGroupEnabled(const ColumnGroup group) const
+    {
+        G4bool isEnabled = false;
+        forEachColumn([&](const auto& column) { isEnabled |= (column.group == group && column.enabled); });
+        return isEnabled;
+    }
+
+    // a vector column not written but still filled, returns false if no vector column has this name
+    G4bool setColumnKept(const std::string& name)
+    {
+        G4bool found = false;
+        forEachColumn(
+            [&](auto& column)
+            {
+                if constexpr (std::decay_t<decltype(column)>::isVector)
+                {
+                    if (name == column.name)
+                    {
+                        column.kept = true;
+                        found = true;
+                    }
+                }
+            });
+        return found;
+    }
+
+    // written or kept columns
+    G4bool isGroupFilled(const ColumnGroup group) const
+    {
+        G4bool isFilled = isGroupEnabled(group);
+        forEachColumn(
+            [&](const auto& column)
+            {
+                if constexpr (std::decay_t<decltype(column)>::isVector)
+                    isFilled |= (column.group == group && column.kept);
+            });
+        return isFilled;
+    }
+
+    // vector columns with an encoding are written as 16 bit codes, see CompactEncoding
+    void setCompact(const G4bool compact)
+    {
+        setGroupEnabled(ColumnGroup::Encoding, compact);
+        forEachColumn(
+            [=](auto& column)
+            {
+                if constexpr (std::decay_t<decltype(column)>::isVector)
+                    column.compact = compact && column.encoding != CompactEncoding::kNone;
+            });
+    }
+
+    // size of the enabled columns of the event before compression
+    std::size_t payloadBytes() const
+    {
+        std::size_t bytes = 0;
+        forEachColumn(
+            [&](const auto& column)
+            {
+                if (!column.enabled)
+                    return;
+
+                if constexpr (std::decay_t<decltype(column)>::isVector)
+                {
+                    if (column.compact)
+                        bytes += column.codes.size() * sizeof(column.codes[0]);
+                    else
+                        bytes += column.data.size() * sizeof(column.data[0]);
+                }
+                else
+                    bytes += sizeof(column.value);
+            });
+        return bytes;
+    }
+
+    // fills the codes of the compact columns from their data
+    void encode(const CompactEncoding& encoding)
+    {
+        positionResolution.set(encoding.positionResolution);
+        logStep.set(encoding.logStep);
+
+        forEachColumn(
+            [&](auto& column)
+            {
+                if constexpr (std::decay_t<decltype(column)>::isVector)
+                {
+                    if (!column.enabled || !column.compact)
+                        return;
+
+                    column.codes.resize(column.data.size());
+                    for (std::size_t i = 0; i < column.data.size(); ++i)
+                        column.codes[i] = encoding.encode(column.encoding, column.data[i]);
+                }
+            });
+    }
+
+  public:
+#define EVENT_RECORD_DECLARE(kind, type, name, unit, group, encoding) \
+    kind##Column<type> name{#name, unit, ColumnGroup::group, CompactEncoding::k##encoding};
+    EVENT_RECORD_COLUMNS(EVENT_RECORD_DECLARE)
+#undef EVENT_RECORD_DECLARE
+};
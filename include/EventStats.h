@@ -0,0 +1,52 @@
+#pragma once
+
+#include <G4ParticleDefinition.hh>
+#include <G4Types.hh>
+
+#include <algorithm>
+
+// Cost of one event, written in the EventStats columns
+struct EventStats
+{
+    G4double wallTime{}; // s
+
+    G4int nSteps{};
+    G4int nTracks{};
+
+    G4int nGammas{};
+    G4int nElectrons{}; // e- and e+
+    G4int nNeutrons{};
+    G4int nProtons{};
+    G4int nIons{};
+    G4int nOthers{};
+
+    G4int peakStack{}; // waiting tracks
+
+    void addTrack(const G4ParticleDefinition* particleDefinition, const G4int nWaitingTracks)
+    {
+        nTracks++;
+        peakStack = std::max(peakStack, nWaitingTracks);
+
+        switch (particleDefinition->GetPDGEncoding())
+        {
+        case 22:
+            nGammas++;
+            break;
+        case 11:
+        case -11:
+            nElectrons++;
+            break;
+        case 2112:
+            nNeutrons++;
+            break;
+        case 2212:
+            nProtons++;
+            break;
+        default:
+            if (particleDefinition->GetAtomicNumber() > 0)
+                nIons++;
+            else
+                nOthers++;
+        }
+    }
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <G4Types.hh>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class EventRecord;
+
+// Per-event predicates deciding whether the event is written, all of them must pass. Each one is given as a
+// string :
+// - gammas:N[:thetaMin:thetaMax] : at least N escaping gammas, with a polar angle in [thetaMin, thetaMax] (deg)
+// - emitters:N                   : at least N positron emitters
+// - emitter:Z:A                  : at least one positron emitter of this species
+class EventTrigger
+{
+  public:
+    explicit EventTrigger(const std::vector<std::string>& specs);
+
+    G4bool isEnabled() const { return !predicates.empty(); }
+
+    // the columns needed by the predicates are filled even if they are not written, e.g. pdgEsc in the minimal tree
+    void keepColumns(EventRecord& record) const;
+
+    G4bool accept(const EventRecord& record) const;
+
+  protected:
+    void addPredicate(const std::string& spec);
+
+  protected:
+    std::vector<std::function<G4bool(const EventRecord&)>> predicates{};
+    std::vector<std::string>                               requiredColumns{};
+};
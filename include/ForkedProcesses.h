@@ -0,0 +1,34 @@
+#pragma once
+
+#include <G4Types.hh>
+
+#include <sys/types.h>
+
+#include <vector>
+
+// Worker processes forked once the run manager is initialised and the physics tables are built, so that they share
+// the geometry and the tables copy-on-write instead of building their own. Each one runs its own event range with its
+// own seed and output file, which the parent merges once they are done. Needs a serial run manager : the threads of
+// the parent do not exist in the children.
+class ForkedProcesses
+{
+  public:
+    ForkedProcesses(const G4int nProcesses, const G4int nEvents);
+
+    // returns the index of the process in the children and -1 in the parent, once all the children are started
+    G4int start();
+
+    // in the parent; false if a child could not be started, crashed or exited with an error
+    G4bool wait();
+
+    // of process i
+    G4int getFirstEvent(const G4int i) const;
+    G4int getNumberOfEvents(const G4int i) const;
+
+  protected:
+    const G4int nProcesses;
+    const G4int nEvents;
+
+    std::vector<pid_t> children{};
+    G4bool             forkFailed = false;
+};
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <G4AnalysisManager.hh>
+
+#include "OutputBackend.h"
+
+// Tree written through G4AnalysisManager, merged on the master by Geant4 in MT mode
+class G4AnalysisBackend : public OutputBackend
+{
+  public:
+    G4AnalysisBackend(const G4bool doNtupleMerging);
+
+    void open(const std::string& fileName, EventRecord& record) override;
+    void fill() override;
+    void close() override;
+
+  protected:
+    G4AnalysisManager* analysisManager = nullptr;
+
+    EventRecord* record = nullptr;
+
+    G4int id_tree{};
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <G4ThreeVector.hh>
+#include <G4Types.hh>
+#include <THnSparse.h>
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class RunSummary;
+
+// Number of nuclei produced per (A, Z, depth bin, radial bin), accumulated by each thread in a hash map instead of
+// one tree entry per nucleus, then copied into a THnSparse of the RunSummary at the end of the run.
+// Depth bins are 1 mm over [0, 300] mm, radial bins 2 mm over [0, 300] mm.
+class NucleiMap
+{
+  public:
+    // keptIsotopes : "Z:A" of the isotopes that still get one tree entry per nucleus
+    explicit NucleiMap(const std::vector<std::string>& keptIsotopes);
+
+    void book(RunSummary& summary);
+
+    void add(const G4int A, const G4int Z, const G4ThreeVector& position);
+
+    G4bool isKept(const G4int A, const G4int Z) const;
+
+    // copies the counts into the histogram, before the summary is merged or written
+    void flush();
+
+  protected:
+    static constexpr G4int nDims = 4;
+
+    static constexpr G4int    maxA = 300;
+    static constexpr G4int    maxZ = 120;
+    static constexpr G4int    nDepthBins = 300;
+    static constexpr G4double maxDepth = 300; // mm
+    static constexpr G4int    nRadialBins = 150;
+    static constexpr G4double maxRadius = 300; // mm
+
+    // 0 is the underflow and n + 1 the overflow, as for the THnSparse axes
+    static G4int bin(const G4double value, const G4int nBins, const G4double max);
+
+  protected:
+    std::vector<std::pair<G4int, G4int>> keptIsotopes{}; // Z, A
+
+    // A, Z, depth bin and radial bin packed in 16 bits each
+    std::unordered_map<std::uint64_t, Long64_t> counts{};
+
+    THnSparseL* histo = nullptr; // owned by the summary
+};
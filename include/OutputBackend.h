@@ -0,0 +1,22 @@
+#pragma once
+
+#include <string>
+
+class EventRecord;
+
+// Writes the enabled columns of the EventRecord as one tree row per event.
+// There is one backend per RootWriter : the master one sets up and finalises the shared output file, the worker
+// ones fill the rows (in sequential mode, or with per-worker files, the same instance does both).
+class OutputBackend
+{
+  public:
+    virtual ~OutputBackend() = default;
+
+    // the backend may keep pointers to the record columns until close()
+    virtual void open(const std::string& fileName, EventRecord& record) = 0;
+    virtual void fill() = 0;
+    virtual void close() = 0;
+
+    // ROOT compression setting (algorithm * 100 + level) from the algorithm name (zlib, lzma, lz4 or zstd)
+    static int compressionSettings(const std::string& algorithm, const int level);
+};
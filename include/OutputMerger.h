@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Merges the per-worker output files (trees or RNTuples and run summary objects) into one file.
+// The inputs are split into groups merged in parallel into temporary files, which are then merged together, so
+// that the run summary histograms are not all added up by a single thread.
+class OutputMerger
+{
+  public:
+    // compression : ROOT compression setting of the output, see OutputBackend::compressionSettings
+    OutputMerger(const int nThreads, const int compression);
+
+    // returns false if a merge failed, the inputs are kept in any case
+    bool merge(const std::vector<std::string>& inputs, const std::string& output) const;
+
+  protected:
+    bool mergeFiles(const std::vector<std::string>& inputs, const std::string& output) const;
+
+    const int nThreads;
+    const int compression;
+};
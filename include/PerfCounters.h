@@ -0,0 +1,47 @@
+#pragma once
+
+#include <G4Types.hh>
+
+#include <array>
+#include <cstdint>
+#include <mutex>
+
+// Hardware counters of the worker threads over the run (Linux perf_event_open) : cycles, instructions, cache
+// misses and branch misses. The worker counts are summed into the master, which reports them per event and per run.
+// Counting is disabled with a warning when perf events are not available (e.g. kernel.perf_event_paranoid > 2).
+class PerfCounters
+{
+  public:
+    PerfCounters();
+    ~PerfCounters();
+
+    // count the calling thread
+    void start();
+    void stop();
+
+    void report(const G4int nEvents) const;
+
+  protected:
+    enum Counter
+    {
+        kCycles,
+        kInstructions,
+        kCacheMisses,
+        kBranchMisses,
+        nCounters
+    };
+
+    void close();
+
+  protected:
+    G4bool isMaster = false;
+    G4bool isWorker = false;
+
+    std::array<int, nCounters>           fds{};
+    std::array<std::uint64_t, nCounters> values{};
+    G4double                             multiplexing = 1; // time enabled / time running, > 1 when multiplexed
+    G4int                                nThreads = 0;     // counted
+
+    static PerfCounters* masterPerfCounters;
+    static std::mutex    mergeMutex;
+};
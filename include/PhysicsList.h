@@ -15,6 +15,9 @@ class PhysicsList : public G4VModularPhysicsList
     void ConstructParticle() override;
     void ConstructProcess() override;
 
+    // names of the physics constructors, in registration order
+    std::vector<G4String> getPhysicsNames() const;
+
   private:
     std::vector<G4VPhysicsConstructor*> physVec;
 };
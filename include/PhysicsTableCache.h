@@ -0,0 +1,37 @@
+#pragma once
+
+#include <G4String.hh>
+#include <G4Types.hh>
+
+class PhysicsList;
+
+// Physics tables stored by a first run in <directory>/<key hash>/ and retrieved by the next runs with the same key.
+// The key describes everything the tables depend on : Geant4 version, physics constructors, production cut, materials
+// and data sets. It is kept in the cache as key.txt and compared in full, not only by its hash, before retrieving.
+// Only the tables with a Geant4 store/retrieve implementation (mostly electromagnetic) are cached, the hadronic data
+// is still loaded at initialisation.
+class PhysicsTableCache
+{
+  public:
+    // after G4RunManager::Initialize, which builds the materials, and before the first BeamOn, which builds the
+    // tables; an empty directory disables the cache
+    PhysicsTableCache(const G4String& directory, PhysicsList* physicsList);
+
+    G4bool isEnabled() const { return !directory.empty(); }
+    G4bool isRetrieved() const { return retrieved; }
+
+    // after the first run, which builds or retrieves the tables : stores them if they were built, and stops
+    // retrieving them otherwise, so that the next geometries build their own
+    void store() const;
+
+  protected:
+    G4String describeConfiguration() const;
+
+  protected:
+    const G4String directory;
+    PhysicsList*   physicsList = nullptr;
+
+    G4String key{};
+    G4String entryDirectory{}; // of this key
+    G4bool   retrieved = false;
+};
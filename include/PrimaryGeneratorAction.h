@@ -23,6 +23,10 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 
     void GeneratePrimaries(G4Event* anEvent) override;
 
+  protected:
+    // particle and energy of the settings
+    void setBeam();
+
   protected:
     RootWriter* rootWriter = nullptr;
 
@@ -31,6 +35,6 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     CLHEP::RandMultiGauss* randMultiGaussX = nullptr;
     CLHEP::RandMultiGauss* randMultiGaussY = nullptr;
 
-    G4String particleName{};
-    G4double beamEnergy{};
+    const Settings& settings; // of the ActionInitialization, the beam may change between runs
+    G4int           beamRunID = -1;
 };
\ No newline at end of file
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <G4Types.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+
+class G4ParticleDefinition;
+class G4Region;
+class G4Step;
+class G4VProcess;
+
+// Step counts and CPU time per (particle, process limiting the step, region).
+// Each step is charged the time since the previous mark (previous step or start of the track) read from the time
+// stamp counter, converted to seconds at the end of the run. The worker profilers are merged into the master one,
+// which prints the table sorted by time.
+class ProcessProfiler
+{
+  public:
+    ProcessProfiler();
+    ~ProcessProfiler();
+
+    void beginRun();
+    void endRun();
+
+    void startTrack() { lastTicks = ticks(); }
+    void addStep(const G4Step* step);
+
+  protected:
+    static std::uint64_t ticks();
+
+    void print() const;
+
+  protected:
+    struct Key
+    {
+        const G4ParticleDefinition* particle;
+        const G4VProcess*           process;
+        const G4Region*             region;
+
+        bool operator==(const Key& other) const
+        {
+            return particle == other.particle && process == other.process && region == other.region;
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            const auto hash = std::hash<const void*>{};
+            return hash(key.particle) ^ (hash(key.process) << 1) ^ (hash(key.region) << 2);
+        }
+    };
+
+    struct Cost
+    {
+        std::uint64_t nSteps{};
+        std::uint64_t ticks{};
+    };
+
+    struct NamedCost
+    {
+        std::uint64_t nSteps{};
+        G4double      time{}; // s
+    };
+
+    // the processes are thread local, so the costs are merged by name
+    using Name = std::tuple<std::string, std::string, std::string>;
+
+    G4bool isMaster = false;
+    G4bool isWorker = false;
+
+    std::unordered_map<Key, Cost, KeyHash> costs{};
+    std::map<Name, NamedCost>              namedCosts{};
+
+    std::uint64_t lastTicks{};
+
+    // to convert the ticks in seconds
+    std::uint64_t                         beginTicks{};
+    std::chrono::steady_clock::time_point beginTime{};
+
+    static ProcessProfiler* masterProfiler;
+    static std::mutex       mergeMutex;
+};
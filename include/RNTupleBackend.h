@@ -0,0 +1,38 @@
+#pragma once
+
+#include "OutputBackend.h"
+#include "Settings.h"
+
+#include <ROOT/REntry.hxx>
+#include <ROOT/RNTupleFillContext.hxx>
+#include <ROOT/RNTupleParallelWriter.hxx>
+
+#include <memory>
+
+// Same logical schema as the trees but written as an RNTuple (ROOT >= 6.34 experimental API).
+// The master owns an RNTupleParallelWriter, each worker fills its own RNTupleFillContext whose entry is bound
+// to the columns of the worker EventRecord, so filling copies nothing. A backend that is both master and worker
+// (sequential mode or per-worker files) owns its writer.
+class RNTupleBackend : public OutputBackend
+{
+  public:
+    RNTupleBackend(const Settings& settings, const G4bool isMaster, const G4bool isWorker);
+
+    void open(const std::string& fileName, EventRecord& record) override;
+    void fill() override;
+    void close() override;
+
+  protected:
+    Settings settings{};
+
+    G4bool isMaster = false;
+    G4bool isWorker = false;
+
+    std::shared_ptr<ROOT::Experimental::RNTupleFillContext> fillContext = nullptr;
+    std::unique_ptr<ROOT::Experimental::REntry>             entry = nullptr;
+
+    std::shared_ptr<ROOT::Experimental::RNTupleParallelWriter> parallelWriter = nullptr;
+
+    // set by the master for the worker-only backends
+    static std::shared_ptr<ROOT::Experimental::RNTupleParallelWriter> masterParallelWriter;
+};
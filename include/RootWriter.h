@@ -1,21 +1,39 @@
 #pragma once
 
-#include <G4AnalysisManager.hh>
-
+#include <G4String.hh>
+#include <G4ThreeVector.hh>
+#include <TParameter.h>
+
+#include "ActivityProfiles.h"
+#include "CompactEncoding.h"
+#include "EscapingHistograms.h"
+#include "EventStats.h"
+#include "EventRecord.h"
+#include "EventTrigger.h"
+#include "NucleiMap.h"
+#include "OutputBackend.h"
+#include "RunMetrics.h"
+#include "RunSummary.h"
 #include "Settings.h"
 
+#include <memory>
+#include <mutex>
+
 class G4ParticleDefinition;
 class G4Step;
+class TH2D;
 
 class RootWriter
 {
   public:
     RootWriter(const Settings& settings);
-    virtual ~RootWriter() = default;
+    virtual ~RootWriter();
 
     void openRootFile(const G4String& name = "test.root");
     void closeRootFile();
 
+    // added to the event numbers of the run, for the event range of a forked process
+    void setFirstEventNumber(const G4int eventNumber) { firstEventNumber = eventNumber; }
     void setEventNumber(const G4int eventNumber);
 
     void addEdep(const CLHEP::Hep3Vector& pos, const double dE);
@@ -33,53 +51,63 @@ class RootWriter
 
     void addNuclei(const G4ParticleDefinition* particleDefinition, const G4ThreeVector& position);
 
+    void setEventStats(const EventStats& stats);
+
     void fillTree();
 
+    // the event does not pass the triggers : counted in the file but not written
+    G4bool acceptEvent() const { return trigger.accept(record); }
+    void   rejectEvent();
+
+    // false when nothing is recorded for the group (columns deselected, no histograms), so callers can skip the work
+    // upstream
+    G4bool doWritePositronEmitters() const { return writePositronEmitters; }
+    G4bool doWriteNuclei() const { return writeNuclei; }
+    G4bool doWriteEscapingParticles() const { return writeEscapingParticles; }
+    G4bool doWriteEventStats() const { return writeEventStats; }
+
   protected:
+    void selectColumns();
     void createHistograms();
 
+    // proton_150_wg_42.root -> proton_150_wg_42_t3.root on worker thread 3
+    static G4String workerFileName(const G4String& name);
+
   protected:
     Settings settings{};
 
-    G4AnalysisManager* analysisManager = nullptr;
-
-    G4int id_edepHisto{};
-    G4int id_tree{};
-
-    G4int id_eventID{};
-    G4int id_primaryEndX{};
-    G4int id_primaryEndY{};
-    G4int id_primaryEndZ{};
-
-    std::vector<int>   AVec{};
-    std::vector<int>   ZVec{};
-    std::vector<float> xVec{};
-    std::vector<float> yVec{};
-    std::vector<float> zVec{};
-    std::vector<float> tVec{};
-
-    std::vector<int>   pdgEscaping{};
-    std::vector<float> xEscaping{};
-    std::vector<float> yEscaping{};
-    std::vector<float> zEscaping{};
-    std::vector<float> thetaEscaping{};
-    std::vector<float> phiEscaping{};
-    std::vector<float> eEscaping{};
-    std::vector<float> timeEscaping{};
-    std::vector<float> initialXEscaping{};
-    std::vector<float> initialYEscaping{};
-    std::vector<float> initialZEscaping{};
-    std::vector<int>   nucleiA{};
-    std::vector<int>   nucleiZ{};
-    std::vector<float> nucleiXPos{};
-    std::vector<float> nucleiYPos{};
-    std::vector<float> nucleiZPos{};
-
-    G4int id_beamPosX{};
-    G4int id_beamPosY{};
-    G4int id_beamPosZ{};
-    G4int id_beamMomX{};
-    G4int id_beamMomY{};
-    G4int id_beamMomZ{};
-    G4int id_beamEnergy{};
+    G4bool isSequential = false;
+    G4bool isMaster = false;
+    G4bool isWorker = false;
+    G4bool ownsFile = false; // sets up and finalises the output file
+
+    G4String fileName{};
+    G4int    firstEventNumber = 0;
+
+    std::unique_ptr<OutputBackend> backend = nullptr; // none on the MT master with per-worker files
+
+    EventRecord     record{};
+    CompactEncoding encoding;
+
+    EventTrigger trigger;
+
+    RunMetrics::Counters& metrics; // of the thread that built the writer
+
+    RunSummary            summary{};
+    TH2D*                 edepHisto = nullptr; // owned by summary
+    TParameter<Long64_t>* nRejectedEvents = nullptr;
+
+    EscapingHistograms escapingHistograms{}; // --escapingHistos
+    NucleiMap          nucleiMap;              // --nucleiMap
+    ActivityProfiles   activityProfiles;       // --activityWindows
+
+    G4bool writePositronEmitters = true;
+    G4bool writeNuclei = true;
+    G4bool writeEscapingParticles = true;
+    G4bool writeBeam = true;
+    G4bool writeEventStats = false;
+
+    // the worker summaries are merged into the master one at the end of the run
+    static RootWriter* masterRootWriter;
+    static std::mutex  mergeMutex;
 };
\ No newline at end of file
@@ -1,31 +1,41 @@
 #pragma once
 
+#include "PerfCounters.h"
+#include "ProcessProfiler.h"
 #include "RootWriter.h"
+#include "RunMetrics.h"
+#include "ThreadPlacement.h"
 
 #include <G4UserRunAction.hh>
 
 #include "Settings.h"
-#include <chrono>
-#include <thread>
 
 class G4Run;
 
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction(const Settings& settings);
+    // the master reports the events per socket of the threadPlacement, if any
+    RunAction(const Settings& settings, ThreadPlacement* threadPlacement = nullptr);
 
     void BeginOfRunAction(const G4Run* run) override;
     void EndOfRunAction(const G4Run* run) override;
 
-    RootWriter* getRootWriter() const { return rootWriter.get(); }
+    RootWriter*      getRootWriter() const { return rootWriter.get(); }
+    ProcessProfiler* getProcessProfiler() const { return processProfiler.get(); }
+
+    // output file name without extension, e.g. proton_150_wg_42
+    static G4String makeRunName(const Settings& settings);
 
   protected:
-    std::unique_ptr<RootWriter> rootWriter = nullptr;
+    std::unique_ptr<RootWriter>      rootWriter = nullptr;
+    std::unique_ptr<ProcessProfiler> processProfiler = nullptr; // --profileProcesses
+    std::unique_ptr<PerfCounters>    perfCounters = nullptr;    // --perfCounters
+    ThreadPlacement*                 threadPlacement = nullptr; // --affinity, of the ActionInitialization
 
-    Settings settings{};
+    const Settings& settings; // of the ActionInitialization, the beam and body may change between runs
 
-    std::chrono::steady_clock::time_point beginTime{};
+    G4String runName{}; // output file name without extension
 
-    std::thread printingThread{};
+    std::unique_ptr<RunMetrics> runMetrics = nullptr; // master only, samples the progress of the runs
 };
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <G4String.hh>
+
+class G4RunManager;
+struct Settings;
+
+// Run manager of the --run-manager setting : serial (G4RunManager), mt (G4MTRunManager, the workers get events in
+// batches of the event modulo), tasking (G4TaskRunManager on the PTL thread pool, the events are tasks and idle threads
+// steal them) or tbb (G4TaskRunManager on TBB, if Geant4 was built with it). nThreads is the number of workers or the
+// size of the thread pool.
+class RunManagerFactory
+{
+  public:
+    static G4RunManager* create(const Settings& settings);
+
+    // throws if the type is not one of the above
+    static void checkType(const G4String& type);
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <G4String.hh>
+#include <G4Types.hh>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Progress of the run : each thread increments its own counters, on their own cache line, and a sampler thread on
+// the master sums them up periodically into rates and a remaining time, printed and optionally written as a status
+// file in JSON (<statusFile>.json) and Prometheus text format (<statusFile>.prom).
+class RunMetrics
+{
+  public:
+    struct alignas(64) Counters
+    {
+        std::atomic<std::uint64_t> nEvents{};
+        std::atomic<std::uint64_t> nSteps{};
+        std::atomic<std::uint64_t> nTracks{};
+        std::atomic<std::uint64_t> nBytes{}; // tree payload before compression
+
+        // only the owning thread writes, so no locked read-modify-write is needed
+        static void add(std::atomic<std::uint64_t>& counter, const std::uint64_t n)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+    // counters of the calling thread, they are never reset
+    static Counters& threadCounters();
+
+  public:
+    RunMetrics(const G4String& statusFile, const G4double interval);
+    ~RunMetrics();
+
+    void startSampling(const G4String& runName, const G4int nEventsToBeProcessed, const G4int nThreads);
+
+    // writes the final status and prints the run summary
+    void stopSampling();
+
+  protected:
+    struct Totals
+    {
+        std::uint64_t nEvents{};
+        std::uint64_t nSteps{};
+        std::uint64_t nTracks{};
+        std::uint64_t nBytes{};
+
+        Totals operator-(const Totals& other) const
+        {
+            return {nEvents - other.nEvents, nSteps - other.nSteps, nTracks - other.nTracks, nBytes - other.nBytes};
+        }
+    };
+
+    // per second
+    struct Rates
+    {
+        Rates(const Totals& delta, const G4double seconds)
+            : nEvents(delta.nEvents / seconds)
+            , nSteps(delta.nSteps / seconds)
+            , nTracks(delta.nTracks / seconds)
+            , nBytes(delta.nBytes / seconds)
+        {
+        }
+
+        G4double nEvents{};
+        G4double nSteps{};
+        G4double nTracks{};
+        G4double nBytes{};
+    };
+
+    static Totals sum();
+
+    void samplerLoop();
+    void report(const Totals& run, const Rates& rates, const G4bool done) const;
+    void writeStatus(const Totals& run, const Rates& rates, const G4double eta, const G4bool done) const;
+
+  protected:
+    const G4String                      statusFile;
+    const std::chrono::duration<double> interval;
+
+    G4String runName{};
+    G4int    nEventsToBeProcessed{};
+    G4int    nThreads{};
+
+    Totals                                baseline{}; // counters at the beginning of the run
+    std::chrono::steady_clock::time_point beginTime{};
+
+    std::thread             samplerThread{};
+    std::mutex              stopMutex{};
+    std::condition_variable stopCondition{};
+    G4bool                  stop = false;
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <TObject.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// Objects (histograms, counters...) accumulated by each thread during the run, next to the tree.
+// Every RootWriter books the same objects in the same order, so that the worker ones can be merged into the
+// master ones at the end of the run.
+class RunSummary
+{
+  public:
+    // takes ownership, the object must not be attached to a directory
+    template <typename T>
+    T* book(std::unique_ptr<T> object)
+    {
+        auto ptr = object.get();
+        objects.push_back(std::move(object));
+        return ptr;
+    }
+
+    // adds the content of other, booked the same way
+    void merge(const RunSummary& other);
+
+    // appends the objects to an existing file
+    void write(const std::string& fileName) const;
+
+    void clear() { objects.clear(); }
+
+  protected:
+    std::vector<std::unique_ptr<TObject>> objects{};
+};
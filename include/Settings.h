@@ -4,6 +4,9 @@
 #include <G4String.hh>
 #include <G4Types.hh>
 
+#include <string>
+#include <vector>
+
 struct Settings
 {
     G4int seed = 0;
@@ -11,6 +14,14 @@ struct Settings
     G4int nThreads = 1;
     G4int nEvents = 0;
 
+    // serial, mt, tasking or tbb, see RunManagerFactory; events per worker request or per task, 0 lets Geant4 choose
+    G4String runManagerType = "mt";
+    G4int    eventModulo = 0;
+
+    // worker thread pinning, or forked process pinning with nProcesses : compact, scatter or a comma separated list of
+    // CPUs, see ThreadPlacement; none if empty
+    G4String affinity = "";
+
     G4String particleName = "proton";
     G4double beamMeanEnergy = 0;
     G4double sigmaEnergy = 0;
@@ -22,4 +33,67 @@ struct Settings
 
     G4bool beamTree = false;
     G4bool minimalTreeForTransverseGammas = false;
+
+    // if not empty, only these tree columns are written
+    std::vector<std::string> columns{};
+    std::vector<std::string> dropColumns{};
+
+    // per-species histograms of the escaping particles instead of the escaping tree columns
+    G4bool escapingHistograms = false;
+
+    // counts of the produced nuclei per (A, Z, depth, radius) instead of one nuclei tree entry per nucleus, except
+    // for the nucleiKeep isotopes (Z:A)
+    G4bool                   nucleiMap = false;
+    std::vector<std::string> nucleiKeep{};
+
+    // activity depth profiles built during the run, for these "begin:end" time windows (min) after an irradiation
+    // of irradiationTime (min) over which the events are spread
+    std::vector<std::string> activityWindows{};
+    G4double                 irradiationTime = 0;
+
+    // per-event wall time, step and track counts in the EventStats columns
+    G4bool eventStats = false;
+
+    // step count and CPU time per particle, process and region, printed at the end of the run
+    G4bool profileProcesses = false;
+
+    // cycles, instructions, cache and branch misses of the workers (Linux perf events)
+    G4bool perfCounters = false;
+
+    // physics tables stored in and retrieved from this directory, see PhysicsTableCache
+    G4String physicsCache = "";
+
+    // progress status files (<statusFile>.json and .prom), rewritten every statusInterval (s)
+    G4String statusFile = "";
+    G4double statusInterval = 2;
+
+    // events failing one of these are not written, see EventTrigger
+    std::vector<std::string> triggers{};
+
+    // 16 bit codes instead of floats for the vector columns, see CompactEncoding
+    G4bool   compactTree = false;
+    G4double positionResolution = 0.1; // mm
+    G4double logStep = 1e-3;
+
+    // g4 (G4AnalysisManager), tree (TTree with TBufferMerger) or rntuple (RNTupleParallelWriter)
+    G4String outputBackend = "g4";
+
+    // tree and rntuple backends only
+    G4String compressionAlgorithm = "zstd";
+    G4int    compressionLevel = 5;
+    G4int    basketSize = 32000;    // bytes
+    G4long   autoFlush = -30000000; // entries if > 0, bytes if < 0 (see TTree::SetAutoFlush)
+
+    // fill the tree from a dedicated writer thread, with this many event buffers per worker
+    G4bool asyncOutput = false;
+    G4int  asyncQueueDepth = 16;
+
+    // one output file per worker thread (_t<threadID> suffix) to be merged with mergeOutput, tree/rntuple only
+    G4bool perWorkerFiles = false;
+
+    // events split over nProcesses processes forked after the initialisation, see ForkedProcesses; each one writes
+    // <run>_p<processIndex>.root, merged by the parent
+    G4int nProcesses = 0;
+    G4int processIndex = -1; // of this forked process, -1 in the parent or without forked processes
+    G4int firstEvent = 0;    // event number of the first event of this process
 };
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread
+template <typename T>
+class SpscQueue
+{
+  public:
+    explicit SpscQueue(const std::size_t capacity)
+        : slots(capacity + 1)
+    {
+    }
+
+    // false if the queue is full
+    bool push(const T& value)
+    {
+        const auto tail = tailIndex.load(std::memory_order_relaxed);
+        const auto next = increment(tail);
+        if (next == headIndex.load(std::memory_order_acquire))
+            return false;
+
+        slots[tail] = value;
+        tailIndex.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // false if the queue is empty
+    bool pop(T& value)
+    {
+        const auto head = headIndex.load(std::memory_order_relaxed);
+        if (head == tailIndex.load(std::memory_order_acquire))
+            return false;
+
+        value = slots[head];
+        headIndex.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return headIndex.load(std::memory_order_acquire) == tailIndex.load(std::memory_order_acquire);
+    }
+
+  protected:
+    std::size_t increment(const std::size_t index) const { return index + 1 == slots.size() ? 0 : index + 1; }
+
+  protected:
+    std::vector<T> slots;
+
+    // on separate cache lines so that the producer and the consumer do not invalidate each other
+    alignas(64) std::atomic<std::size_t> headIndex{0};
+    alignas(64) std::atomic<std::size_t> tailIndex{0};
+};
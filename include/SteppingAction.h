@@ -6,13 +6,17 @@
 #include "Settings.h"
 
 class G4Step;
+class ProcessProfiler;
 class RootWriter;
 class TrackingAction;
 
 class SteppingAction : public G4UserSteppingAction
 {
   public:
-    SteppingAction(RootWriter* rootWriter, TrackingAction* trackingAction, const Settings& settings);
+    SteppingAction(RootWriter*      rootWriter,
+                   TrackingAction*  trackingAction,
+                   ProcessProfiler* processProfiler,
+                   const Settings&  settings);
 
     void UserSteppingAction(const G4Step* step) override;
 
@@ -20,7 +24,8 @@ class SteppingAction : public G4UserSteppingAction
     void HandleBeamInBody(const G4Step* step);
 
   protected:
-    RootWriter*     rootWriter = nullptr;
-    TrackingAction* trackingAction = nullptr;
-    G4bool          omitNeutrons = false;
+    RootWriter*      rootWriter = nullptr;
+    TrackingAction*  trackingAction = nullptr;
+    ProcessProfiler* processProfiler = nullptr;
+    G4bool           omitNeutrons = false;
 };
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "RunMetrics.h"
+
+#include <G4String.hh>
+#include <G4Types.hh>
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Pins each worker thread to a CPU (Linux), so that its histograms and output buffers, allocated by the thread once
+// pinned, stay on the memory of its socket. Placement policies over the CPUs allowed to the process :
+//   compact : the physical cores of the first socket, then their hyperthreads, then the next socket
+//   scatter : round robin over the sockets, hyperthreads last
+//   a comma separated list of CPUs, e.g. 0,2,4,6, used in this order
+// The master reports the event rate per socket at the end of each run, with its rate per thread relative to the
+// fastest socket as efficiency.
+class ThreadPlacement
+{
+  public:
+    // on the master, before the workers are started
+    explicit ThreadPlacement(const G4String& policy);
+
+    // pins the calling thread, before it allocates its buffers
+    void pin(const G4int threadID);
+
+    void beginRun();
+    void report() const;
+
+  protected:
+    struct Cpu
+    {
+        G4int id{};
+        G4int socket{};
+        G4int core{};    // rank of its physical core in the socket
+        G4int sibling{}; // 0 for the first hyperthread of the core
+    };
+
+    // threads pinned on a socket and their event counters at the beginning of the run
+    struct Thread
+    {
+        G4int                       socket{};
+        const RunMetrics::Counters* counters = nullptr;
+        std::uint64_t               nEventsAtBeginOfRun{};
+    };
+
+    static std::vector<Cpu> readTopology();
+
+  protected:
+    const G4String   policy;
+    std::vector<Cpu> cpus{}; // in placement order
+
+    mutable std::mutex                    threadsMutex{};
+    std::vector<Thread>                   threads{};
+    std::chrono::steady_clock::time_point beginTime{};
+};
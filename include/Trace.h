@@ -0,0 +1,50 @@
+#pragma once
+
+// Chrome trace (chrome://tracing, Perfetto) zones, compiled only with the WITH_TRACING CMake option.
+// TRACE_ZONE("name") records the begin and end of the enclosing scope with the thread in a per-thread ring buffer,
+// TRACE_WRITE(fileName) writes all the buffers as Chrome trace JSON and empties them.
+
+#ifdef WITH_TRACING
+
+#include <cstdint>
+#include <string>
+
+namespace Trace
+{
+std::uint64_t now(); // ns
+
+void record(const char* name, const std::uint64_t begin, const std::uint64_t end);
+
+void write(const std::string& fileName);
+
+class Zone
+{
+  public:
+    explicit Zone(const char* name)
+        : name(name)
+        , begin(now())
+    {
+    }
+
+    ~Zone() { record(name, begin, now()); }
+
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+
+  protected:
+    const char* const   name;
+    const std::uint64_t begin;
+};
+} // namespace Trace
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+#define TRACE_ZONE(name) const Trace::Zone TRACE_CONCAT(traceZone, __LINE__){name}
+#define TRACE_WRITE(fileName) Trace::write(fileName)
+
+#else
+
+#define TRACE_ZONE(name)
+#define TRACE_WRITE(fileName) static_cast<void>(0)
+
+#endif
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "EventStats.h"
 #include "ParticleMemory.h"
+#include "RunMetrics.h"
 #include <G4Types.hh>
 #include <G4UserTrackingAction.hh>
 
@@ -9,12 +11,13 @@
 
 class RunAction;
 class G4ParticleDefinition;
+class ProcessProfiler;
 class RootWriter;
 
 class TrackingAction : public G4UserTrackingAction
 {
   public:
-    TrackingAction(RootWriter* rootWriter);
+    TrackingAction(RootWriter* rootWriter, ProcessProfiler* processProfiler);
 
     void PreUserTrackingAction(const G4Track* track) override;
     void PostUserTrackingAction(const G4Track* track) override;
@@ -27,12 +30,20 @@ class TrackingAction : public G4UserTrackingAction
 
     G4bool doPrintParticleMemoryMap() const { return printParticleMemoryMap; }
 
+    const EventStats& getEventStats() const { return eventStats; }
+
   protected:
-    RootWriter* rootWriter = nullptr;
+    RootWriter*      rootWriter = nullptr;
+    ProcessProfiler* processProfiler = nullptr;
 
     std::map<G4int, G4int>           childParentRelationMap{};
     std::map<G4int, std::set<G4int>> parentChildrenRelationMap{};
     std::map<G4int, ParticleMemory>  particleMemoryMap{};
 
     G4bool printParticleMemoryMap = false;
+
+    RunMetrics::Counters& metrics;
+
+    G4bool     collectEventStats = false;
+    EventStats eventStats{};
 };
\ No newline at end of file
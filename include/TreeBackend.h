@@ -0,0 +1,41 @@
+#pragma once
+
+#include "OutputBackend.h"
+#include "Settings.h"
+
+#include <ROOT/TBufferMerger.hxx>
+
+#include <memory>
+
+class TTree;
+
+// Tree written directly with ROOT, each worker fills its own TTree in a TBufferMergerFile and the master
+// TBufferMerger merges them in the output file. A backend that is both master and worker (sequential mode or
+// per-worker files) owns its TBufferMerger.
+// Gives control over the compression algorithm and level, the basket size and the auto flush.
+class TreeBackend : public OutputBackend
+{
+  public:
+    TreeBackend(const Settings& settings, const G4bool isMaster, const G4bool isWorker);
+
+    void open(const std::string& fileName, EventRecord& record) override;
+    void fill() override;
+    void close() override;
+
+  protected:
+    Settings settings{};
+
+    G4bool isMaster = false;
+    G4bool isWorker = false;
+
+    std::shared_ptr<ROOT::TBufferMerger>     bufferMerger = nullptr;
+    std::shared_ptr<ROOT::TBufferMergerFile> file = nullptr;
+    TTree*                                   tree = nullptr; // owned by file
+
+    // uncompressed bytes a worker keeps in memory before handing its baskets to the merger
+    static constexpr Long64_t writeInterval = 32 * 1024 * 1024;
+    Long64_t                  bytesSinceWrite{};
+
+    // set by the master for the worker-only backends
+    static std::shared_ptr<ROOT::TBufferMerger> masterBufferMerger;
+};
@@ -11,28 +11,47 @@
 
 #include <G4RunManager.hh>
 #include <G4String.hh>
+#include <G4Threading.hh>
 
 ActionInitialization::ActionInitialization(const Settings& settings)
     : settings(settings)
+{
+    checkSettings(settings);
+
+    // with forked processes, Build runs in the parent before the fork : each child pins itself instead, otherwise all
+    // of them would inherit the CPU of the parent
+    if (!settings.affinity.empty() && settings.nProcesses == 0)
+        threadPlacement = std::make_unique<ThreadPlacement>(settings.affinity);
+}
+
+void ActionInitialization::checkSettings(const Settings& settings)
 {
     if (settings.particleName != "proton" && settings.particleName != "carbon")
         throw std::logic_error("proton or carbon only");
 
     if (settings.bodyMaterial != "water" && settings.bodyMaterial != "waterGel")
         throw std::logic_error("water or waterGel only");
+
+    if (settings.beamMeanEnergy < 0)
+        throw std::logic_error("positive beam energy please");
 }
 
 void ActionInitialization::BuildForMaster() const
 {
-    auto runAction = new RunAction(settings);
+    auto runAction = new RunAction(settings, threadPlacement.get());
     SetUserAction(runAction);
 }
 
 void ActionInitialization::Build() const
 {
-    auto runAction = new RunAction(settings);
+    // first, so that the buffers of the actions are allocated on the memory of the socket of the thread
+    if (threadPlacement)
+        threadPlacement->pin(G4Threading::G4GetThreadId());
+
+    auto runAction = new RunAction(settings, threadPlacement.get());
 
     auto rootWriter = runAction->getRootWriter();
+    auto processProfiler = runAction->getProcessProfiler();
 
     auto primaryGeneratorAction = new PrimaryGeneratorAction(rootWriter, settings);
     SetUserAction(primaryGeneratorAction);
@@ -59,9 +78,9 @@ void ActionInitialization::Build() const
 
     // primaryGeneratorAction->setBeamProfile(matrixXPX, matrixYPY);
 
-    auto trackingAction = new TrackingAction(rootWriter);
+    auto trackingAction = new TrackingAction(rootWriter, processProfiler);
     auto eventAction = new EventAction(rootWriter, trackingAction);
-    auto steppingAction = new SteppingAction(rootWriter, trackingAction, settings);
+    auto steppingAction = new SteppingAction(rootWriter, trackingAction, processProfiler, settings);
 
     SetUserAction(runAction);
     SetUserAction(eventAction);
@@ -0,0 +1,102 @@
+#include "ActivityProfiles.h"
+#include "RunSummary.h"
+
+#include <CLHEP/Units/SystemOfUnits.h>
+#include <TH1D.h>
+
+#include <array>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+struct Isotope
+{
+    const char* name;
+    G4int       A;
+    G4int       Z;
+};
+
+constexpr std::array<Isotope, 3> isotopes = {{
+    {"O15", 15, 8},
+    {"C11", 11, 6},
+    {"N13", 13, 7},
+}};
+} // namespace
+
+ActivityProfiles::ActivityProfiles(const std::vector<std::string>& windowSpecs,
+                                   const G4double                  irradiationTime,
+                                   const G4int                     nEvents)
+    : irradiationTime(irradiationTime)
+    , nEvents(nEvents)
+{
+    for (const auto& spec : windowSpecs)
+    {
+        const auto error = std::logic_error("activity windows must be given as begin:end (min) : " + spec);
+
+        const auto separator = spec.find(':');
+        if (separator == std::string::npos)
+            throw error;
+
+        try
+        {
+            const auto begin = std::stod(spec.substr(0, separator)) * CLHEP::minute;
+            const auto end = std::stod(spec.substr(separator + 1)) * CLHEP::minute;
+            if (end <= begin)
+                throw error;
+            windows.push_back({begin, end});
+        }
+        catch (const std::invalid_argument&)
+        {
+            throw error;
+        }
+    }
+}
+
+void ActivityProfiles::book(RunSummary& summary)
+{
+    for (auto i = 0U; i < windows.size(); ++i)
+    {
+        auto& window = windows[i];
+        window.histos.clear();
+
+        std::ostringstream title{};
+        title << "activity from " << window.begin / CLHEP::minute << " to " << window.end / CLHEP::minute
+              << " min;depth (mm)";
+
+        for (auto j = 0U; j <= isotopes.size(); ++j)
+        {
+            const auto name =
+                std::string{"activity_"} + (j < isotopes.size() ? isotopes[j].name : "all") + "_" + std::to_string(i);
+
+            auto histo = std::make_unique<TH1D>(name.c_str(), title.str().c_str(), 300, 0, 300);
+            histo->SetDirectory(nullptr);
+            window.histos.push_back(summary.book(std::move(histo)));
+        }
+    }
+}
+
+void ActivityProfiles::beginEvent(const G4int eventID)
+{
+    eventTime = nEvents > 0 ? irradiationTime * (1. * eventID / nEvents - 1) : 0;
+}
+
+void ActivityProfiles::add(const G4int A, const G4int Z, const G4double depth, const G4double time)
+{
+    const auto decayTime = eventTime + time;
+
+    auto isotope = 0U;
+    while (isotope < isotopes.size() && (isotopes[isotope].A != A || isotopes[isotope].Z != Z))
+        ++isotope;
+
+    for (auto& window : windows)
+    {
+        if (decayTime <= window.begin || decayTime >= window.end)
+            continue;
+
+        if (isotope < isotopes.size())
+            window.histos[isotope]->Fill(depth / CLHEP::mm);
+        window.histos.back()->Fill(depth / CLHEP::mm);
+    }
+}
@@ -0,0 +1,233 @@
+#ifdef WITH_ALLOCATION_COUNTING
+
+#include "AllocationCounter.h"
+
+#include <G4Types.hh>
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace
+{
+using AllocationCounter::Category;
+using AllocationCounter::nCategories;
+
+// plain thread locals, so that operator new never runs an initialiser or allocates
+thread_local Category      currentCategory = AllocationCounter::kGeant4;
+thread_local std::uint64_t nAllocations[nCategories] = {};
+thread_local std::uint64_t nBytes[nCategories] = {};
+
+void count(const std::size_t size)
+{
+    nAllocations[currentCategory]++;
+    nBytes[currentCategory] += size;
+}
+
+void* allocate(const std::size_t size)
+{
+    count(size);
+    if (const auto pointer = std::malloc(size > 0 ? size : 1))
+        return pointer;
+    throw std::bad_alloc{};
+}
+
+void* allocateAligned(const std::size_t size, const std::align_val_t alignment)
+{
+    count(size);
+    const auto align = static_cast<std::size_t>(alignment);
+    // aligned_alloc needs a multiple of the alignment
+    if (const auto pointer = std::aligned_alloc(align, std::max((size + align - 1) / align, std::size_t{1}) * align))
+        return pointer;
+    throw std::bad_alloc{};
+}
+
+const char* const categoryNames[nCategories] = {"Geant4", "stepping", "tracking", "event", "writer"};
+
+// events of one thread, they outlive their thread so that the master can report them
+struct ThreadStats
+{
+    std::uint64_t nEvents{};
+
+    std::array<std::uint64_t, nCategories> allocations{};
+    std::array<std::uint64_t, nCategories> bytes{};
+    std::array<std::uint64_t, nCategories> maxAllocations{}; // in one event
+
+    // counters at the end of the previous event or the beginning of the run
+    std::array<std::uint64_t, nCategories> previousAllocations{};
+    std::array<std::uint64_t, nCategories> previousBytes{};
+};
+
+std::mutex                                statsMutex{};
+std::vector<std::unique_ptr<ThreadStats>> allStats{};
+
+ThreadStats& threadStats()
+{
+    thread_local const auto stats = []
+    {
+        std::lock_guard<std::mutex> lock{statsMutex};
+        allStats.push_back(std::make_unique<ThreadStats>());
+        return allStats.back().get();
+    }();
+
+    return *stats;
+}
+} // namespace
+
+AllocationCounter::Category AllocationCounter::setCategory(const Category category)
+{
+    const auto previous = currentCategory;
+    currentCategory = category;
+    return previous;
+}
+
+void AllocationCounter::beginRun()
+{
+    auto& stats = threadStats();
+
+    std::lock_guard<std::mutex> lock{statsMutex};
+    std::copy(std::begin(nAllocations), std::end(nAllocations), stats.previousAllocations.begin());
+    std::copy(std::begin(nBytes), std::end(nBytes), stats.previousBytes.begin());
+}
+
+void AllocationCounter::endEvent()
+{
+    auto& stats = threadStats();
+
+    // only contended by the report, between the runs
+    std::lock_guard<std::mutex> lock{statsMutex};
+
+    stats.nEvents++;
+    for (auto i = 0; i < nCategories; ++i)
+    {
+        const auto eventAllocations = nAllocations[i] - stats.previousAllocations[i];
+
+        stats.allocations[i] += eventAllocations;
+        stats.bytes[i] += nBytes[i] - stats.previousBytes[i];
+        stats.maxAllocations[i] = std::max(stats.maxAllocations[i], eventAllocations);
+
+        stats.previousAllocations[i] = nAllocations[i];
+        stats.previousBytes[i] = nBytes[i];
+    }
+}
+
+void AllocationCounter::report()
+{
+    ThreadStats total{};
+
+    {
+        std::lock_guard<std::mutex> lock{statsMutex};
+        for (const auto& stats : allStats)
+        {
+            total.nEvents += stats->nEvents;
+            for (auto i = 0; i < nCategories; ++i)
+            {
+                total.allocations[i] += stats->allocations[i];
+                total.bytes[i] += stats->bytes[i];
+                total.maxAllocations[i] = std::max(total.maxAllocations[i], stats->maxAllocations[i]);
+            }
+
+            stats->nEvents = 0;
+            stats->allocations = {};
+            stats->bytes = {};
+            stats->maxAllocations = {};
+        }
+    }
+
+    if (total.nEvents == 0)
+        return;
+
+    const auto nEvents = static_cast<G4double>(total.nEvents);
+
+    G4cout << "heap allocations per event over " << total.nEvents << " events" << G4endl;
+    G4cout << std::setw(10) << "charged to" << std::setw(16) << "allocations" << std::setw(12) << "kB"
+           << std::setw(16) << "max in 1 event" << G4endl;
+
+    for (auto i = 0; i < nCategories; ++i)
+        G4cout << std::setw(10) << categoryNames[i] << std::setw(16) << std::fixed << std::setprecision(1)
+               << total.allocations[i] / nEvents << std::setw(12) << total.bytes[i] / nEvents / 1e3 << std::setw(16)
+               << total.maxAllocations[i] << G4endl;
+}
+
+// replaceable allocation functions, see [new.delete]
+
+void* operator new(std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+    return allocate(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    count(size);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    count(size);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return allocateAligned(size, alignment);
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+#endif
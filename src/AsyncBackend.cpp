@@ -0,0 +1,167 @@
+#include "AsyncBackend.h"
+
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+std::thread                AsyncBackend::writerThread{};
+std::atomic<G4bool>        AsyncBackend::stopWriter{false};
+std::mutex                 AsyncBackend::writerThreadMutex{};
+G4int                      AsyncBackend::nWriterThreadUsers = 0;
+std::mutex                 AsyncBackend::backendsMutex{};
+std::vector<AsyncBackend*> AsyncBackend::backends{};
+
+AsyncBackend::AsyncBackend(std::unique_ptr<OutputBackend> wrappedBackend,
+                           const G4bool                   isMaster,
+                           const G4bool                   isWorker,
+                           const std::size_t              queueDepth)
+    : backend(std::move(wrappedBackend))
+    , isMaster(isMaster)
+    , isWorker(isWorker)
+    , filledBuffers(queueDepth)
+    , freeBuffers(queueDepth)
+{
+    // fill() waits for a free buffer
+    if (queueDepth == 0)
+        throw std::logic_error("the asynchronous output needs at least one event buffer per worker");
+
+    if (!isWorker)
+        return;
+
+    // allocated on the worker thread
+    for (auto i = 0U; i < queueDepth; ++i)
+    {
+        buffers.push_back(std::make_unique<EventRecord>());
+        freeBuffers.push(buffers.back().get());
+    }
+}
+
+void AsyncBackend::open(const std::string& fileName, EventRecord& eventRecord)
+{
+    // the master opens before the workers start their run
+    if (isMaster)
+        startWriterThread();
+
+    record = &eventRecord;
+
+    if (!isWorker)
+    {
+        backend->open(fileName, eventRecord);
+        return;
+    }
+
+    boundRecord.copyLayout(eventRecord);
+    for (auto& buffer : buffers)
+        buffer->copyLayout(eventRecord);
+
+    backend->open(fileName, boundRecord);
+
+    std::lock_guard<std::mutex> lock{backendsMutex};
+    backends.push_back(this);
+}
+
+void AsyncBackend::fill()
+{
+    EventRecord* buffer = nullptr;
+
+    if (!freeBuffers.pop(buffer))
+    {
+        nStalls++;
+        while (!freeBuffers.pop(buffer))
+            std::this_thread::yield();
+    }
+
+    buffer->swap(*record);
+
+    nPending++;
+    filledBuffers.push(buffer); // cannot be full, there are as many slots as buffers
+}
+
+G4bool AsyncBackend::writePending()
+{
+    EventRecord* buffer = nullptr;
+    if (!filledBuffers.pop(buffer))
+        return false;
+
+    boundRecord.swap(*buffer);
+    backend->fill();
+
+    // the buffer now holds the previous event
+    buffer->clear();
+    freeBuffers.push(buffer);
+
+    nPending--;
+    return true;
+}
+
+void AsyncBackend::close()
+{
+    using namespace std::chrono_literals;
+
+    if (isWorker)
+    {
+        while (nPending > 0)
+            std::this_thread::sleep_for(1ms);
+
+        {
+            std::lock_guard<std::mutex> lock{backendsMutex};
+            backends.erase(std::remove(backends.begin(), backends.end(), this), backends.end());
+        }
+
+        if (nStalls > 0)
+            G4cout << "asynchronous output : the worker waited for the writer thread for " << nStalls << " events"
+                   << G4endl;
+        nStalls = 0;
+    }
+
+    // the master closes after all the workers
+    if (isMaster)
+        stopWriterThread();
+
+    backend->close();
+    record = nullptr;
+}
+
+// with per-worker files every worker is a master, the first one starts the thread and the last one stops it
+void AsyncBackend::startWriterThread()
+{
+    std::lock_guard<std::mutex> lock{writerThreadMutex};
+    if (nWriterThreadUsers++ > 0)
+        return;
+
+    stopWriter = false;
+    writerThread = std::thread(writerLoop);
+}
+
+void AsyncBackend::stopWriterThread()
+{
+    std::lock_guard<std::mutex> lock{writerThreadMutex};
+    if (--nWriterThreadUsers > 0)
+        return;
+
+    stopWriter = true;
+    if (writerThread.joinable())
+        writerThread.join();
+}
+
+void AsyncBackend::writerLoop()
+{
+    using namespace std::chrono_literals;
+
+    while (!stopWriter)
+    {
+        G4bool didWrite = false;
+
+        {
+            std::lock_guard<std::mutex> lock{backendsMutex};
+            // one event per worker and per sweep so that no worker waits behind a busier one
+            for (auto asyncBackend : backends)
+                didWrite |= asyncBackend->writePending();
+        }
+
+        if (!didWrite)
+            std::this_thread::sleep_for(100us);
+    }
+}
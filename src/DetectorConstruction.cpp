@@ -6,6 +6,7 @@
 #include <G4NistManager.hh>
 #include <G4PVPlacement.hh>
 #include <G4Region.hh>
+#include <G4RegionStore.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4Tubs.hh>
 #include <G4UserLimits.hh>
@@ -13,10 +14,15 @@
 #include <stdexcept>
 
 DetectorConstruction::DetectorConstruction(const Settings& settings)
+    : settings(settings)
+{
+}
+
+G4VPhysicalVolume* DetectorConstruction::Construct()
 {
     bodyWidth = settings.bodyWidth * CLHEP::cm;
     if (bodyWidth < 0)
-        throw;
+        throw std::logic_error("positive body width please");
 
     if (settings.bodyMaterial == "waterGel")
         bodyMaterialType = kWaterGel;
@@ -25,24 +31,26 @@ DetectorConstruction::DetectorConstruction(const Settings& settings)
 
     G4cout << "Body is " << settings.bodyMaterial << G4endl;
     G4cout << "Body width : " << bodyWidth / CLHEP::cm << " cm" << G4endl;
-}
 
-G4VPhysicalVolume* DetectorConstruction::Construct()
-{
     auto nist = G4NistManager::Instance();
 
     G4Material* bodyMaterial = nullptr;
 
+    // the materials and regions are kept when the geometry is rebuilt
     if (bodyMaterialType == kWaterGel)
     {
-        auto H = nist->FindOrBuildElement(1);
-        auto C = nist->FindOrBuildElement(6);
-        auto O = nist->FindOrBuildElement(8);
-
-        bodyMaterial = new G4Material("WaterGel", 1.010 * g / cm3, 3);
-        bodyMaterial->AddElement(H, 0.11);
-        bodyMaterial->AddElement(C, 0.04650);
-        bodyMaterial->AddElement(O, 0.8435);
+        bodyMaterial = G4Material::GetMaterial("WaterGel", false);
+        if (!bodyMaterial)
+        {
+            auto H = nist->FindOrBuildElement(1);
+            auto C = nist->FindOrBuildElement(6);
+            auto O = nist->FindOrBuildElement(8);
+
+            bodyMaterial = new G4Material("WaterGel", 1.010 * g / cm3, 3);
+            bodyMaterial->AddElement(H, 0.11);
+            bodyMaterial->AddElement(C, 0.04650);
+            bodyMaterial->AddElement(O, 0.8435);
+        }
     }
     else if (bodyMaterialType == kWater)
     {
@@ -81,7 +89,9 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 
     new G4PVPlacement(nullptr, {0, 0, 0.5 * bodyLength}, logicBody, "Body", logicWorld, false, 0, true);
 
-    auto bodyRegion = new G4Region("Body");
+    auto bodyRegion = G4RegionStore::GetInstance()->GetRegion("Body", false);
+    if (!bodyRegion)
+        bodyRegion = new G4Region("Body");
     bodyRegion->AddRootLogicalVolume(logicBody);
 
     return physWorld;
@@ -0,0 +1,59 @@
+#include "EscapingHistograms.h"
+#include "RunSummary.h"
+
+#include <CLHEP/Units/SystemOfUnits.h>
+#include <TH1D.h>
+
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+template <typename... Binning>
+TH1D* bookHisto(RunSummary& summary, const std::string& name, const char* title, const Binning... binning)
+{
+    auto histo = std::make_unique<TH1D>(name.c_str(), title, binning...);
+    histo->SetDirectory(nullptr);
+    return summary.book(std::move(histo));
+}
+} // namespace
+
+void EscapingHistograms::book(RunSummary& summary)
+{
+    // total energy from 1 keV to 10 GeV, 50 bins per decade
+    constexpr auto        nEnergyBins = 350;
+    std::vector<G4double> energyBins(nEnergyBins + 1);
+    for (auto i = 0; i <= nEnergyBins; ++i)
+        energyBins[i] = std::pow(10., -3 + 7. * i / nEnergyBins);
+
+    for (auto& s : species)
+    {
+        const auto prefix = std::string{"esc_"} + s.name;
+
+        s.energy = bookHisto(summary, prefix + "_e", ";E (MeV)", nEnergyBins, energyBins.data());
+        s.theta = bookHisto(summary, prefix + "_theta", ";#theta (rad)", 180, 0, CLHEP::pi);
+        s.phi = bookHisto(summary, prefix + "_phi", ";#phi (rad)", 360, -CLHEP::pi, CLHEP::pi);
+        s.exitZ = bookHisto(summary, prefix + "_z", ";exit z (mm)", 300, 0, 300);
+        s.originZ = bookHisto(summary, prefix + "_initialZ", ";initial z (mm)", 300, 0, 300);
+    }
+}
+
+void EscapingHistograms::fill(const G4int    pdg,
+                              const G4double energy,
+                              const G4double theta,
+                              const G4double phi,
+                              const G4double exitZ,
+                              const G4double originZ)
+{
+    auto s = species.begin();
+    while (s->pdg != pdg && s->pdg != 0)
+        ++s;
+
+    s->energy->Fill(energy / CLHEP::MeV);
+    s->theta->Fill(theta / CLHEP::rad);
+    s->phi->Fill(phi / CLHEP::rad);
+    s->exitZ->Fill(exitZ / CLHEP::mm);
+    s->originZ->Fill(originZ / CLHEP::mm);
+}
@@ -1,5 +1,7 @@
 #include "EventAction.h"
+#include "AllocationCounter.h"
 #include "RootWriter.h"
+#include "Trace.h"
 #include "TrackingAction.h"
 
 #include <CLHEP/Units/SystemOfUnits.h>
@@ -7,27 +9,49 @@
 #include <G4RunManager.hh>
 #include <G4Track.hh>
 
-std::atomic<G4int> EventAction::nEventsProcessed = 0;
-
 EventAction::EventAction(RootWriter* rootWriter, TrackingAction* ta)
     : rootWriter(rootWriter)
     , trackingAction(ta)
+    , metrics(RunMetrics::threadCounters())
 {
 }
 
 void EventAction::BeginOfEventAction(const G4Event* event)
 {
+    TRACE_ZONE("BeginOfEventAction");
+    ALLOCATION_SCOPE(Event);
+
     rootWriter->setEventNumber(event->GetEventID());
+
+    if (rootWriter->doWriteEventStats())
+        eventBeginTime = std::chrono::steady_clock::now();
 }
 
 void EventAction::EndOfEventAction(const G4Event*)
 {
-    rootWriter->fillTree();
+    TRACE_ZONE("EndOfEventAction");
+    ALLOCATION_SCOPE(Event);
+
+    if (rootWriter->doWriteEventStats())
+    {
+        const std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - eventBeginTime;
+
+        auto stats = trackingAction->getEventStats();
+        stats.wallTime = wallTime.count();
+        rootWriter->setEventStats(stats);
+    }
+
+    if (rootWriter->acceptEvent())
+        rootWriter->fillTree();
+    else
+        rootWriter->rejectEvent();
 
     // if (trackingAction->doPrintParticleMemoryMap())
     //     trackingAction->printParticleMemory();
 
     trackingAction->reset();
 
-    nEventsProcessed++;
+    RunMetrics::Counters::add(metrics.nEvents, 1);
+
+    ALLOCATION_END_EVENT();
 }
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "EventTrigger.h"
+#include "EventRecord.h"
+
+#include <CLHEP/Units/SystemOfUnits.h>
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+EventTrigger::EventTrigger(const std::vector<std::string>& specs)
+{
+    for (const auto& spec : specs)
+        addPredicate(spec);
+}
+
+void EventTrigger::addPredicate(const std::string& spec)
+{
+    std::vector<std::string> fields{};
+    std::istringstream       stream{spec};
+    for (std::string field{}; std::getline(stream, field, ':');)
+        fields.push_back(field);
+
+    const auto error = std::logic_error("invalid trigger : " + spec);
+
+    std::vector<double> args{};
+    try
+    {
+        for (auto i = 1U; i < fields.size(); ++i)
+            args.push_back(std::stod(fields[i]));
+    }
+    catch (const std::exception&)
+    {
+        throw error;
+    }
+
+    const auto& name = fields.empty() ? spec : fields[0];
+
+    if (name == "gammas" && (args.size() == 1 || args.size() == 3))
+    {
+        const auto nMin = static_cast<std::size_t>(args[0]);
+        const auto thetaMin = args.size() == 3 ? args[1] * CLHEP::deg : 0.;
+        const auto thetaMax = args.size() == 3 ? args[2] * CLHEP::deg : CLHEP::pi;
+
+        requiredColumns.insert(requiredColumns.end(), {"pdgEsc", "thetaEsc"});
+        predicates.emplace_back(
+            [=](const EventRecord& record)
+            {
+                const auto& pdg = record.pdgEsc.data;
+                const auto& theta = record.thetaEsc.data;
+
+                std::size_t n = 0;
+                for (auto i = 0U; i < pdg.size() && n < nMin; ++i)
+                {
+                    const auto angle = theta[i] * record.thetaEsc.unit;
+                    if (pdg[i] == 22 && angle >= thetaMin && angle <= thetaMax)
+                        n++;
+                }
+                return n >= nMin;
+            });
+    }
+    else if (name == "emitters" && args.size() == 1)
+    {
+        const auto nMin = static_cast<std::size_t>(args[0]);
+
+        requiredColumns.emplace_back("A");
+        predicates.emplace_back([=](const EventRecord& record) { return record.A.data.size() >= nMin; });
+    }
+    else if (name == "emitter" && args.size() == 2)
+    {
+        const auto Z = static_cast<int>(args[0]);
+        const auto A = static_cast<int>(args[1]);
+
+        requiredColumns.insert(requiredColumns.end(), {"Z", "A"});
+        predicates.emplace_back(
+            [=](const EventRecord& record)
+            {
+                for (auto i = 0U; i < record.A.data.size(); ++i)
+                {
+                    if (record.Z.data[i] == Z && record.A.data[i] == A)
+                        return true;
+                }
+                return false;
+            });
+    }
+    else
+        throw error;
+}
+
+void EventTrigger::keepColumns(EventRecord& record) const
+{
+    for (const auto& name : requiredColumns)
+    {
+        if (!record.setColumnKept(name))
+            throw std::logic_error("the trigger needs the column " + name);
+    }
+}
+
+G4bool EventTrigger::accept(const EventRecord& record) const
+{
+    return std::all_of(predicates.begin(), predicates.end(), [&](const auto& predicate) { return predicate(record); });
+}
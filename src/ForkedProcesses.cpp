@@ -0,0 +1,89 @@
+#include "ForkedProcesses.h"
+
+#include <G4ios.hh>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+ForkedProcesses::ForkedProcesses(const G4int nProcesses, const G4int nEvents)
+    : nProcesses(std::max(nProcesses, 1))
+    , nEvents(nEvents)
+{
+}
+
+G4int ForkedProcesses::start()
+{
+    // otherwise the buffered output of the parent is printed by every child
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+
+    for (auto i = 0; i < nProcesses; ++i)
+    {
+        const auto pid = fork();
+
+        if (pid == 0)
+            return i;
+
+        if (pid < 0)
+        {
+            G4cout << "forked processes : fork failed (" << std::strerror(errno) << "), " << nProcesses - i
+                   << " processes not started" << G4endl;
+            forkFailed = true;
+            break;
+        }
+
+        children.push_back(pid);
+    }
+
+    G4cout << children.size() << " processes started" << G4endl;
+
+    return -1;
+}
+
+G4bool ForkedProcesses::wait()
+{
+    auto success = !forkFailed;
+
+    for (auto i = 0U; i < children.size(); ++i)
+    {
+        int status{};
+        if (waitpid(children[i], &status, 0) < 0)
+        {
+            G4cout << "forked processes : waitpid failed for process " << i << " (" << std::strerror(errno) << ")"
+                   << G4endl;
+            success = false;
+        }
+        else if (WIFSIGNALED(status))
+        {
+            G4cout << "forked processes : process " << i << " killed by signal " << WTERMSIG(status) << G4endl;
+            success = false;
+        }
+        else if (WEXITSTATUS(status) != 0)
+        {
+            G4cout << "forked processes : process " << i << " exited with " << WEXITSTATUS(status) << G4endl;
+            success = false;
+        }
+    }
+
+    children.clear();
+
+    return success;
+}
+
+G4int ForkedProcesses::getFirstEvent(const G4int i) const
+{
+    // the first nEvents % nProcesses processes run one more event
+    return i * (nEvents / nProcesses) + std::min(i, nEvents % nProcesses);
+}
+
+G4int ForkedProcesses::getNumberOfEvents(const G4int i) const
+{
+    return nEvents / nProcesses + (i < nEvents % nProcesses ? 1 : 0);
+}
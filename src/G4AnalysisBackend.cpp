@@ -0,0 +1,90 @@
+#include "G4AnalysisBackend.h"
+#include "EventRecord.h"
+
+#include <type_traits>
+
+G4AnalysisBackend::G4AnalysisBackend(const G4bool doNtupleMerging)
+{
+    analysisManager = G4AnalysisManager::Instance();
+    analysisManager->SetVerboseLevel(0);
+
+    if (doNtupleMerging)
+        analysisManager->SetNtupleMerging(true);
+}
+
+void G4AnalysisBackend::open(const std::string& fileName, EventRecord& eventRecord)
+{
+    record = &eventRecord;
+
+    analysisManager->OpenFile(fileName);
+
+    id_tree = analysisManager->CreateNtuple("tree", "tree");
+
+    record->forEachColumn(
+        [&](auto& column)
+        {
+            if (!column.enabled)
+                return;
+
+            using Column = std::decay_t<decltype(column)>;
+            using Type = typename Column::value_type;
+
+            // G4 ntuples have no 16 bit columns, the codes are written as int and left to the compression
+            if constexpr (Column::isVector)
+            {
+                if (column.compact)
+                    column.id = analysisManager->CreateNtupleIColumn(id_tree, column.name, column.intCodes);
+                else if constexpr (std::is_same_v<Type, int>)
+                    column.id = analysisManager->CreateNtupleIColumn(id_tree, column.name, column.data);
+                else
+                    column.id = analysisManager->CreateNtupleFColumn(id_tree, column.name, column.data);
+            }
+            else if constexpr (std::is_same_v<Type, int>)
+                column.id = analysisManager->CreateNtupleIColumn(id_tree, column.name);
+            else if constexpr (std::is_same_v<Type, float>)
+                column.id = analysisManager->CreateNtupleFColumn(id_tree, column.name);
+            else
+                column.id = analysisManager->CreateNtupleDColumn(id_tree, column.name);
+        });
+
+    analysisManager->FinishNtuple(id_tree);
+}
+
+void G4AnalysisBackend::fill()
+{
+    // the vector columns are read through their references, only the scalars and the codes have to be copied
+    record->forEachColumn(
+        [&](auto& column)
+        {
+            using Column = std::decay_t<decltype(column)>;
+            using Type = typename Column::value_type;
+
+            if constexpr (Column::isVector)
+            {
+                if (column.enabled && column.compact)
+                    column.intCodes.assign(column.codes.begin(), column.codes.end());
+            }
+            else
+            {
+                if (!column.enabled)
+                    return;
+
+                if constexpr (std::is_same_v<Type, int>)
+                    analysisManager->FillNtupleIColumn(id_tree, column.id, column.value);
+                else if constexpr (std::is_same_v<Type, float>)
+                    analysisManager->FillNtupleFColumn(id_tree, column.id, column.value);
+                else
+                    analysisManager->FillNtupleDColumn(id_tree, column.id, column.value);
+            }
+        });
+
+    analysisManager->AddNtupleRow(id_tree);
+}
+
+void G4AnalysisBackend::close()
+{
+    analysisManager->Write();
+    analysisManager->CloseFile();
+
+    record = nullptr;
+}
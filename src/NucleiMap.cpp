@@ -0,0 +1,78 @@
+#include "NucleiMap.h"
+#include "RunSummary.h"
+
+#include <CLHEP/Units/SystemOfUnits.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+
+NucleiMap::NucleiMap(const std::vector<std::string>& isotopes)
+{
+    for (const auto& isotope : isotopes)
+    {
+        const auto error = std::logic_error("isotopes must be given as Z:A : " + isotope);
+
+        const auto separator = isotope.find(':');
+        if (separator == std::string::npos)
+            throw error;
+
+        try
+        {
+            const auto Z = std::stoi(isotope.substr(0, separator));
+            const auto A = std::stoi(isotope.substr(separator + 1));
+            keptIsotopes.emplace_back(Z, A);
+        }
+        catch (const std::exception&)
+        {
+            throw error;
+        }
+    }
+}
+
+void NucleiMap::book(RunSummary& summary)
+{
+    const Int_t    nBins[nDims] = {maxA + 1, maxZ + 1, nDepthBins, nRadialBins};
+    const Double_t min[nDims] = {-0.5, -0.5, 0, 0};
+    const Double_t max[nDims] = {maxA + 0.5, maxZ + 0.5, maxDepth, maxRadius};
+
+    auto map = std::make_unique<THnSparseL>("nucleiMap", "nuclei produced;A;Z;depth (mm);radius (mm)", nDims, nBins,
+                                            min, max);
+    histo = summary.book(std::move(map));
+}
+
+G4int NucleiMap::bin(const G4double value, const G4int nBins, const G4double max)
+{
+    if (value < 0)
+        return 0;
+    return std::min(static_cast<G4int>(value / max * nBins) + 1, nBins + 1);
+}
+
+void NucleiMap::add(const G4int A, const G4int Z, const G4ThreeVector& position)
+{
+    const std::uint64_t depthBin = bin(position.z() / CLHEP::mm, nDepthBins, maxDepth);
+    const std::uint64_t radialBin = bin(position.perp() / CLHEP::mm, nRadialBins, maxRadius);
+
+    const std::uint64_t aBin = std::clamp(A, -1, maxA + 1) + 1;
+    const std::uint64_t zBin = std::clamp(Z, -1, maxZ + 1) + 1;
+
+    counts[aBin << 48 | zBin << 32 | depthBin << 16 | radialBin]++;
+}
+
+G4bool NucleiMap::isKept(const G4int A, const G4int Z) const
+{
+    return std::find(keptIsotopes.begin(), keptIsotopes.end(), std::make_pair(Z, A)) != keptIsotopes.end();
+}
+
+void NucleiMap::flush()
+{
+    for (const auto& [key, count] : counts)
+    {
+        const Int_t bins[nDims] = {static_cast<Int_t>(key >> 48), static_cast<Int_t>(key >> 32 & 0xffff),
+                                   static_cast<Int_t>(key >> 16 & 0xffff), static_cast<Int_t>(key & 0xffff)};
+        histo->SetBinContent(bins, count);
+    }
+
+    counts.clear();
+}
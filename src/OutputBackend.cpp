@@ -0,0 +1,24 @@
+#include "OutputBackend.h"
+
+#include <Compression.h>
+
+#include <map>
+#include <stdexcept>
+
+int OutputBackend::compressionSettings(const std::string& algorithm, const int level)
+{
+    using Algorithm = ROOT::RCompressionSetting::EAlgorithm;
+
+    static const std::map<std::string, Algorithm::EValues> algorithms = {
+        {"zlib", Algorithm::kZLIB},
+        {"lzma", Algorithm::kLZMA},
+        {"lz4", Algorithm::kLZ4},
+        {"zstd", Algorithm::kZSTD},
+    };
+
+    const auto it = algorithms.find(algorithm);
+    if (it == algorithms.end())
+        throw std::logic_error("compression algorithm must be zlib, lzma, lz4 or zstd");
+
+    return ROOT::CompressionSettings(it->second, level);
+}
@@ -0,0 +1,64 @@
+#include "OutputMerger.h"
+
+#include <ROOT/TThreadExecutor.hxx>
+#include <TFileMerger.h>
+#include <TROOT.h>
+
+#include <algorithm>
+#include <filesystem>
+
+OutputMerger::OutputMerger(const int nThreads, const int compression)
+    : nThreads(std::max(nThreads, 1))
+    , compression(compression)
+{
+}
+
+bool OutputMerger::mergeFiles(const std::vector<std::string>& inputs, const std::string& output) const
+{
+    // no local copy of the inputs, and the histograms are merged file by file rather than in one go
+    TFileMerger merger{false, false};
+    merger.SetPrintLevel(0);
+    merger.SetFastMethod(true);
+
+    if (!merger.OutputFile(output.c_str(), "RECREATE", compression))
+        return false;
+
+    for (const auto& input : inputs)
+    {
+        if (!merger.AddFile(input.c_str(), false))
+            return false;
+    }
+
+    return merger.Merge();
+}
+
+bool OutputMerger::merge(const std::vector<std::string>& inputs, const std::string& output) const
+{
+    const auto nGroups = std::min<std::size_t>(nThreads, inputs.size() / 2);
+    if (nGroups <= 1)
+        return mergeFiles(inputs, output);
+
+    std::vector<std::vector<std::string>> groups(nGroups);
+    for (auto i = 0U; i < inputs.size(); ++i)
+        groups[i % nGroups].push_back(inputs[i]);
+
+    std::vector<std::string> partialOutputs{};
+    for (auto i = 0U; i < nGroups; ++i)
+        partialOutputs.push_back(output + ".part" + std::to_string(i));
+
+    const auto mergeGroup = [&](const unsigned i) -> int { return mergeFiles(groups[i], partialOutputs[i]); };
+
+    // the concurrent mergers share gROOT and the current directory
+    ROOT::EnableThreadSafety();
+
+    ROOT::TThreadExecutor executor{static_cast<unsigned>(nThreads)};
+    const auto            results = executor.Map(mergeGroup, ROOT::TSeqU{static_cast<unsigned>(nGroups)});
+
+    const auto success = std::all_of(results.begin(), results.end(), [](const int result) { return result; })
+                      && mergeFiles(partialOutputs, output);
+
+    for (const auto& partialOutput : partialOutputs)
+        std::filesystem::remove(partialOutput);
+
+    return success;
+}
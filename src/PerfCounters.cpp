@@ -0,0 +1,153 @@
+#include "PerfCounters.h"
+
+#include <G4RunManager.hh>
+#include <G4Threading.hh>
+#include <G4ios.hh>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+PerfCounters* PerfCounters::masterPerfCounters = nullptr;
+std::mutex    PerfCounters::mergeMutex{};
+
+PerfCounters::PerfCounters()
+{
+    const auto runManager = G4RunManager::GetRunManager();
+    const auto isSequential = runManager->GetRunManagerType() == G4RunManager::sequentialRM;
+
+    isMaster = G4Threading::IsMasterThread();
+    isWorker = !isMaster || isSequential;
+
+    fds.fill(-1);
+
+    if (isMaster)
+        masterPerfCounters = this;
+}
+
+PerfCounters::~PerfCounters()
+{
+    close();
+
+    if (masterPerfCounters == this)
+        masterPerfCounters = nullptr;
+}
+
+void PerfCounters::close()
+{
+#ifdef __linux__
+    for (auto& fd : fds)
+    {
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+    }
+#endif
+}
+
+void PerfCounters::start()
+{
+    values.fill(0);
+    multiplexing = 1;
+    nThreads = 0;
+
+    if (!isWorker)
+        return;
+
+#ifdef __linux__
+    constexpr std::array<std::uint64_t, nCounters> configs = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+                                                              PERF_COUNT_HW_CACHE_MISSES,
+                                                              PERF_COUNT_HW_BRANCH_MISSES};
+
+    // one group led by the cycles so that the counters are scheduled together
+    for (auto i = 0; i < nCounters; ++i)
+    {
+        perf_event_attr attr{};
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = configs[i];
+        attr.disabled = i == kCycles;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // this thread, any CPU
+        fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, i == kCycles ? -1 : fds[kCycles], 0);
+        if (fds[i] < 0)
+        {
+            const auto error = errno;
+            static std::once_flag warning{};
+            std::call_once(warning,
+                           [=]
+                           {
+                               G4cout << "perf counters : perf_event_open failed (" << std::strerror(error)
+                                      << "), no hardware counters" << G4endl;
+                           });
+            close();
+            return;
+        }
+    }
+
+    ioctl(fds[kCycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fds[kCycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+    G4cout << "perf counters : only available on Linux" << G4endl;
+#endif
+}
+
+void PerfCounters::stop()
+{
+#ifdef __linux__
+    if (fds[kCycles] >= 0)
+    {
+        ioctl(fds[kCycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // nr, time enabled, time running, values
+        std::array<std::uint64_t, 3 + nCounters> data{};
+        if (read(fds[kCycles], data.data(), sizeof(data)) == sizeof(data) && data[2] > 0)
+        {
+            multiplexing = static_cast<G4double>(data[1]) / data[2];
+            for (auto i = 0; i < nCounters; ++i)
+                values[i] = data[3 + i] * multiplexing;
+            nThreads = 1;
+        }
+
+        close();
+    }
+#endif
+
+    // the workers stop before the master
+    if (!isMaster)
+    {
+        std::lock_guard<std::mutex> lock{mergeMutex};
+        for (auto i = 0; i < nCounters; ++i)
+            masterPerfCounters->values[i] += values[i];
+        masterPerfCounters->multiplexing = std::max(masterPerfCounters->multiplexing, multiplexing);
+        masterPerfCounters->nThreads += nThreads;
+    }
+}
+
+void PerfCounters::report(const G4int nEvents) const
+{
+    if (nThreads == 0)
+        return;
+
+    const auto perEvent = [&](const Counter counter) { return static_cast<G4double>(values[counter]) / nEvents; };
+
+    G4cout << "hardware counters on " << nThreads << " threads"
+           << (multiplexing > 1 ? " (multiplexed, scaled up to " + std::to_string(multiplexing) + ")" : "") << " :\n"
+           << "  cycles       " << values[kCycles] << "\t" << perEvent(kCycles) << " / event\n"
+           << "  instructions " << values[kInstructions] << "\t" << perEvent(kInstructions) << " / event\n"
+           << "  cache misses " << values[kCacheMisses] << "\t" << perEvent(kCacheMisses) << " / event\n"
+           << "  branch miss  " << values[kBranchMisses] << "\t" << perEvent(kBranchMisses) << " / event\n"
+           << "  instructions per cycle " << static_cast<G4double>(values[kInstructions]) / values[kCycles]
+           << ", cache misses per 1000 instructions " << 1e3 * values[kCacheMisses] / values[kInstructions]
+           << G4endl;
+}
@@ -45,6 +45,14 @@ void PhysicsList::ConstructParticle()
         phys->ConstructParticle();
 }
 
+std::vector<G4String> PhysicsList::getPhysicsNames() const
+{
+    std::vector<G4String> names{};
+    for (const auto& phys : physVec)
+        names.push_back(phys->GetPhysicsName());
+    return names;
+}
+
 void PhysicsList::ConstructProcess()
 {
     AddTransportation();
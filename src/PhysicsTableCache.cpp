@@ -0,0 +1,142 @@
+#include "PhysicsTableCache.h"
+#include "PhysicsList.h"
+
+#include <CLHEP/Units/SystemOfUnits.h>
+#include <G4Element.hh>
+#include <G4IonisParamMat.hh>
+#include <G4Material.hh>
+#include <G4Version.hh>
+#include <G4ios.hh>
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// the data sets, e.g. G4LEDATA, of the environment
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+PhysicsTableCache::PhysicsTableCache(const G4String& directory, PhysicsList* physicsList)
+    : directory(directory)
+    , physicsList(physicsList)
+{
+    if (!isEnabled())
+        return;
+
+    key = describeConfiguration();
+
+    std::stringstream hash{};
+    hash << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(key);
+    entryDirectory = (fs::path{std::string{directory}} / hash.str()).string();
+
+    std::ifstream keyFile{fs::path{std::string{entryDirectory}} / "key.txt"};
+    if (!keyFile)
+    {
+        G4cout << "physics table cache : no entry for this configuration, the tables will be stored in "
+               << entryDirectory << G4endl;
+        return;
+    }
+
+    std::stringstream storedKey{};
+    storedKey << keyFile.rdbuf();
+
+    if (storedKey.str() != key)
+        G4cout << "physics table cache : " << entryDirectory
+               << " was stored for another configuration (hash collision), the tables are rebuilt" << G4endl;
+    else
+    {
+        physicsList->SetPhysicsTableRetrieved(entryDirectory);
+        retrieved = true;
+        G4cout << "physics table cache : retrieving the tables from " << entryDirectory << G4endl;
+    }
+}
+
+G4String PhysicsTableCache::describeConfiguration() const
+{
+    std::stringstream description{};
+    description << std::setprecision(10);
+
+    description << "geant4 " << G4Version << "\n";
+
+    description << "physics";
+    for (const auto& name : physicsList->getPhysicsNames())
+        description << " " << name;
+    description << "\n";
+
+    description << "cut " << physicsList->GetDefaultCutValue() / CLHEP::mm << " mm\n";
+
+    for (const auto material : *G4Material::GetMaterialTable())
+    {
+        description << "material " << material->GetName() << " " << material->GetDensity() / (CLHEP::g / CLHEP::cm3)
+                    << " g/cm3 " << material->GetIonisation()->GetMeanExcitationEnergy() / CLHEP::eV << " eV";
+
+        const auto fractions = material->GetFractionVector();
+        for (std::size_t i = 0; i < material->GetNumberOfElements(); ++i)
+            description << " " << material->GetElement(i)->GetZ() << ":" << fractions[i];
+        description << "\n";
+    }
+
+    // the data set directories carry their version, e.g. G4EMLOW8.5
+    std::vector<std::string> dataSets{};
+    for (auto variable = environ; *variable; ++variable)
+    {
+        const auto entry = std::string{*variable};
+        const auto name = entry.substr(0, entry.find('='));
+        if (name.rfind("G4", 0) == 0 && name.size() > 4 && name.compare(name.size() - 4, 4, "DATA") == 0)
+            dataSets.push_back(entry);
+    }
+    std::sort(dataSets.begin(), dataSets.end());
+    for (const auto& dataSet : dataSets)
+        description << "data " << dataSet << "\n";
+
+    return description.str();
+}
+
+void PhysicsTableCache::store() const
+{
+    if (!isEnabled())
+        return;
+
+    // the entry only matches the materials of the first run : the tables rebuilt later for a new geometry, e.g. by a
+    // scan or a server request, are built rather than retrieved from it
+    if (retrieved)
+    {
+        physicsList->ResetPhysicsTableRetrieved();
+        return;
+    }
+
+    // written aside and renamed, so that concurrent jobs never retrieve a partial entry
+    const auto entry = fs::path{std::string{entryDirectory}};
+    const auto tmp = fs::path{entry.string() + ".tmp" + std::to_string(getpid())};
+
+    std::error_code error{};
+    fs::create_directories(tmp, error);
+
+    if (error || !physicsList->StorePhysicsTable(tmp.string()))
+    {
+        G4cout << "physics table cache : failed to store the tables in " << tmp.string() << G4endl;
+        fs::remove_all(tmp, error);
+        return;
+    }
+
+    {
+        std::ofstream keyFile{tmp / "key.txt"};
+        keyFile << key;
+    }
+
+    // another job may have stored the same entry in the meantime
+    fs::rename(tmp, entry, error);
+    if (error)
+        fs::remove_all(tmp, error);
+    else
+        G4cout << "physics table cache : tables stored in " << entry.string() << G4endl;
+}
@@ -1,6 +1,7 @@
 #include "PrimaryGeneratorAction.h"
 
 #include "RootWriter.h"
+#include "Trace.h"
 
 #include <CLHEP/Matrix/SymMatrix.h>
 #include <CLHEP/Matrix/Vector.h>
@@ -10,6 +11,7 @@
 #include <G4IonTable.hh>
 #include <G4ParticleGun.hh>
 #include <G4ParticleTable.hh>
+#include <G4Run.hh>
 #include <G4RunManager.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4ios.hh>
@@ -18,23 +20,17 @@
 
 PrimaryGeneratorAction::PrimaryGeneratorAction(RootWriter* rootWriter, const Settings& settings)
     : rootWriter(rootWriter)
-    , particleName(settings.particleName)
-    , beamEnergy(settings.beamMeanEnergy * CLHEP::MeV)
+    , settings(settings)
 {
-    if (particleName != "proton" && particleName != "carbon")
+    if (settings.particleName != "proton" && settings.particleName != "carbon")
         throw std::logic_error("proton or carbon only");
 
-    if (beamEnergy < 0)
+    if (settings.beamMeanEnergy < 0)
         throw std::logic_error("positive beam energy please");
 
     particleGun = new G4ParticleGun(1);
     particleGun->SetParticleMomentumDirection({0, 0, 1});
     particleGun->SetParticlePosition({0, 0, -20 * CLHEP::cm});
-
-    const auto threadID = G4Threading::G4GetThreadId();
-
-    if (threadID < 1)
-        G4cout << particleName << " beam at " << beamEnergy / CLHEP::MeV << " MeV/u" << G4endl;
 }
 
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
@@ -56,23 +52,37 @@ void PrimaryGeneratorAction::setBeamProfile(const CLHEP::HepSymMatrix& matrixXPX
     randMultiGaussY = new CLHEP::RandMultiGauss(*randEngine, means, matrixYPY);
 }
 
-void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
+void PrimaryGeneratorAction::setBeam()
 {
-    auto particleDefinition = particleGun->GetParticleDefinition();
+    G4ParticleDefinition* particleDefinition = nullptr;
+    if (settings.particleName == "proton")
+        particleDefinition = G4ParticleTable::GetParticleTable()->FindParticle("proton");
+    else
+        particleDefinition = G4IonTable::GetIonTable()->GetIon(1000060120);
 
-    if (particleDefinition->GetPDGEncoding() == 0) // if it is a geantino, the particle def was never set yet
-    {
-        if (particleName == "proton")
-            particleDefinition = G4ParticleTable::GetParticleTable()->FindParticle("proton");
-        else
-            particleDefinition = G4IonTable::GetIonTable()->GetIon(1000060120);
+    particleGun->SetParticleDefinition(particleDefinition);
+
+    const auto baryonNumber = particleDefinition->GetBaryonNumber();
+    particleGun->SetParticleEnergy(settings.beamMeanEnergy * CLHEP::MeV * baryonNumber);
 
-        particleGun->SetParticleDefinition(particleDefinition);
+    if (G4Threading::G4GetThreadId() < 1)
+        G4cout << settings.particleName << " beam at " << settings.beamMeanEnergy << " MeV/u" << G4endl;
+}
 
-        const auto baryonNumber = particleDefinition->GetBaryonNumber();
-        particleGun->SetParticleEnergy(beamEnergy * baryonNumber);
+void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
+{
+    TRACE_ZONE("GeneratePrimaries");
+
+    // at the first event of each run, the beam may change between runs
+    const auto runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+    if (runID != beamRunID)
+    {
+        setBeam();
+        beamRunID = runID;
     }
 
+    const auto particleDefinition = particleGun->GetParticleDefinition();
+
     if (randMultiGaussX)
     {
         const auto vecX = randMultiGaussX->fire();
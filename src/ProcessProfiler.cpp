@@ -0,0 +1,140 @@
+#include "ProcessProfiler.h"
+
+#include <G4LogicalVolume.hh>
+#include <G4ParticleDefinition.hh>
+#include <G4Region.hh>
+#include <G4RunManager.hh>
+#include <G4Step.hh>
+#include <G4Threading.hh>
+#include <G4VPhysicalVolume.hh>
+#include <G4VProcess.hh>
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+ProcessProfiler* ProcessProfiler::masterProfiler = nullptr;
+std::mutex       ProcessProfiler::mergeMutex{};
+
+ProcessProfiler::ProcessProfiler()
+{
+    const auto runManager = G4RunManager::GetRunManager();
+    const auto isSequential = runManager->GetRunManagerType() == G4RunManager::sequentialRM;
+
+    isMaster = G4Threading::IsMasterThread();
+    isWorker = !isMaster || isSequential;
+
+    if (isMaster)
+        masterProfiler = this;
+}
+
+ProcessProfiler::~ProcessProfiler()
+{
+    if (masterProfiler == this)
+        masterProfiler = nullptr;
+}
+
+std::uint64_t ProcessProfiler::ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+void ProcessProfiler::beginRun()
+{
+    costs.clear();
+    namedCosts.clear();
+
+    beginTime = std::chrono::steady_clock::now();
+    beginTicks = ticks();
+    lastTicks = beginTicks;
+}
+
+void ProcessProfiler::addStep(const G4Step* step)
+{
+    const auto now = ticks();
+
+    const auto process = step->GetPostStepPoint()->GetProcessDefinedStep();
+    const auto region = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetRegion();
+
+    auto& cost = costs[{step->GetTrack()->GetParticleDefinition(), process, region}];
+    cost.nSteps++;
+    cost.ticks += now - lastTicks;
+
+    lastTicks = now;
+}
+
+void ProcessProfiler::endRun()
+{
+    // the workers end before the master
+    if (isWorker)
+    {
+        const std::chrono::duration<double> time = std::chrono::steady_clock::now() - beginTime;
+        const auto                          ticksPerSecond = (ticks() - beginTicks) / time.count();
+
+        for (const auto& [key, cost] : costs)
+        {
+            const auto name = Name{key.particle->GetParticleName(),
+                                   key.process ? key.process->GetProcessName() : G4String{"none"},
+                                   key.region ? key.region->GetName() : G4String{"none"}};
+
+            auto& namedCost = namedCosts[name];
+            namedCost.nSteps += cost.nSteps;
+            namedCost.time += cost.ticks / ticksPerSecond;
+        }
+        costs.clear();
+    }
+
+    if (!isMaster)
+    {
+        std::lock_guard<std::mutex> lock{mergeMutex};
+        for (const auto& [name, cost] : namedCosts)
+        {
+            auto& masterCost = masterProfiler->namedCosts[name];
+            masterCost.nSteps += cost.nSteps;
+            masterCost.time += cost.time;
+        }
+        return;
+    }
+
+    print();
+}
+
+void ProcessProfiler::print() const
+{
+    std::vector<std::pair<Name, NamedCost>> rows(namedCosts.begin(), namedCosts.end());
+    std::sort(rows.begin(), rows.end(), [](const auto& a, const auto& b) { return a.second.time > b.second.time; });
+
+    G4double      totalTime = 0;
+    std::uint64_t totalSteps = 0;
+    for (const auto& [name, cost] : rows)
+    {
+        totalTime += cost.time;
+        totalSteps += cost.nSteps;
+    }
+
+    G4cout << "CPU time per particle, process and region, " << totalSteps << " steps in " << totalTime << " s\n"
+           << std::left << std::setw(20) << "particle" << std::setw(24) << "process" << std::setw(12) << "region"
+           << std::right << std::setw(14) << "steps" << std::setw(12) << "time (s)" << std::setw(9) << "time %"
+           << std::setw(11) << "ns/step" << "\n";
+
+    for (const auto& [name, cost] : rows)
+    {
+        const auto& [particle, process, region] = name;
+
+        G4cout << std::left << std::setw(20) << particle << std::setw(24) << process << std::setw(12) << region
+               << std::right << std::setw(14) << cost.nSteps << std::fixed << std::setprecision(3) << std::setw(12)
+               << cost.time << std::setprecision(2) << std::setw(9) << 100 * cost.time / totalTime
+               << std::setprecision(0) << std::setw(11) << 1e9 * cost.time / cost.nSteps << std::defaultfloat
+               << "\n";
+    }
+    G4cout << G4endl;
+}
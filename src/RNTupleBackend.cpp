@@ -0,0 +1,104 @@
+#include "RNTupleBackend.h"
+#include "EventRecord.h"
+
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriteOptions.hxx>
+
+#include <cstdint>
+#include <type_traits>
+
+std::shared_ptr<ROOT::Experimental::RNTupleParallelWriter> RNTupleBackend::masterParallelWriter = nullptr;
+
+RNTupleBackend::RNTupleBackend(const Settings& settings, const G4bool isMaster, const G4bool isWorker)
+    : settings(settings)
+    , isMaster(isMaster)
+    , isWorker(isWorker)
+{
+    // throws early on a wrong algorithm name
+    compressionSettings(settings.compressionAlgorithm, settings.compressionLevel);
+}
+
+void RNTupleBackend::open(const std::string& fileName, EventRecord& record)
+{
+    using namespace ROOT::Experimental;
+
+    // the master opens before the workers start their run, its record has the same enabled columns as theirs
+    if (isMaster)
+    {
+        auto model = RNTupleModel::Create();
+
+        record.forEachColumn(
+            [&](const auto& column)
+            {
+                if (!column.enabled)
+                    return;
+
+                using Column = std::decay_t<decltype(column)>;
+
+                if constexpr (Column::isVector)
+                {
+                    if (column.compact)
+                        model->MakeField<std::vector<std::int16_t>>(column.name);
+                    else
+                        model->MakeField<std::vector<typename Column::value_type>>(column.name);
+                }
+                else
+                    model->MakeField<typename Column::value_type>(column.name);
+            });
+
+        auto options = RNTupleWriteOptions{};
+        options.SetCompression(compressionSettings(settings.compressionAlgorithm, settings.compressionLevel));
+
+        parallelWriter = RNTupleParallelWriter::Recreate(std::move(model), "tree", fileName, options);
+
+        if (!isWorker)
+        {
+            masterParallelWriter = parallelWriter;
+            return;
+        }
+    }
+    else
+        parallelWriter = masterParallelWriter;
+
+    fillContext = parallelWriter->CreateFillContext();
+    entry = fillContext->GetModel().CreateBareEntry();
+
+    record.forEachColumn(
+        [&](auto& column)
+        {
+            if (!column.enabled)
+                return;
+
+            using Column = std::decay_t<decltype(column)>;
+
+            if constexpr (Column::isVector)
+            {
+                if (column.compact)
+                    entry->BindRawPtr(column.name, &column.codes);
+                else
+                    entry->BindRawPtr(column.name, &column.data);
+            }
+            else
+                entry->BindRawPtr(column.name, &column.value);
+        });
+}
+
+void RNTupleBackend::fill()
+{
+    fillContext->Fill(*entry);
+}
+
+void RNTupleBackend::close()
+{
+    // destroying the fill context flushes its last cluster
+    if (isWorker)
+    {
+        entry.reset();
+        fillContext.reset();
+    }
+
+    // the master closes after all the workers, destroying the writer commits the dataset
+    if (isMaster && !isWorker)
+        masterParallelWriter.reset();
+    parallelWriter.reset();
+}
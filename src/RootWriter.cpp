@@ -1,140 +1,250 @@
 #include "RootWriter.h"
+#include "AllocationCounter.h"
+#include "AsyncBackend.h"
+#include "G4AnalysisBackend.h"
+#include "RNTupleBackend.h"
+#include "TreeBackend.h"
 
 #include <CLHEP/Units/SystemOfUnits.h>
-#include <G4AnalysisManager.hh>
 #include <G4RunManager.hh>
 #include <G4Step.hh>
+#include <G4Threading.hh>
 #include <G4ios.hh>
+#include <TH2D.h>
+#include <TParameter.h>
+#include <TROOT.h>
 
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "EventRecord.h"
 #include "Settings.h"
+#include "Trace.h"
 #include "TrackInformation.h"
 
+RootWriter* RootWriter::masterRootWriter = nullptr;
+std::mutex  RootWriter::mergeMutex{};
+
 RootWriter::RootWriter(const Settings& settings)
     : settings(settings)
+    , encoding(settings.positionResolution, settings.logStep)
+    , trigger(settings.triggers)
+    , metrics(RunMetrics::threadCounters())
+    , nucleiMap(settings.nucleiKeep)
+    , activityProfiles(settings.activityWindows, settings.irradiationTime * CLHEP::minute, settings.nEvents)
 {
-    analysisManager = G4AnalysisManager::Instance();
-    analysisManager->SetVerboseLevel(0);
-
     const auto runManager = G4RunManager::GetRunManager();
-    const auto type = runManager->GetRunManagerType();
+    isSequential = runManager->GetRunManagerType() == G4RunManager::sequentialRM;
+
+    isMaster = G4Threading::IsMasterThread();
+    isWorker = !isMaster || isSequential;
+
+    // with per-worker files each worker is the master of its own file and the MT master has none
+    ownsFile = settings.perWorkerFiles ? isWorker : isMaster;
+
+    // the histograms are booked concurrently by the workers
+    if (isMaster)
+    {
+        ROOT::EnableThreadSafety();
+        masterRootWriter = this;
+    }
+
+    // checked by the MT master, which has no file with per-worker files, so that it throws on the main thread rather
+    // than on the workers
+    if (settings.perWorkerFiles && !isSequential && settings.outputBackend == "g4")
+        throw std::logic_error("per-worker files need the tree or rntuple backend");
+
+    if (!ownsFile && !isWorker)
+        return;
+
+    if (settings.outputBackend == "g4")
+        backend = std::make_unique<G4AnalysisBackend>(!isSequential);
+    else if (settings.outputBackend == "tree")
+        backend = std::make_unique<TreeBackend>(settings, ownsFile, isWorker);
+    else if (settings.outputBackend == "rntuple")
+        backend = std::make_unique<RNTupleBackend>(settings, ownsFile, isWorker);
+    else
+        throw std::logic_error("output backend must be g4, tree or rntuple");
+
+    if (settings.asyncOutput)
+    {
+        if (settings.outputBackend == "g4")
+            throw std::logic_error("the asynchronous output needs the tree or rntuple backend");
+
+        backend = std::make_unique<AsyncBackend>(std::move(backend), ownsFile, isWorker, settings.asyncQueueDepth);
+    }
+
+    selectColumns();
+}
+
+RootWriter::~RootWriter()
+{
+    if (masterRootWriter == this)
+        masterRootWriter = nullptr;
+}
 
-    if (type != G4RunManager::sequentialRM)
-        analysisManager->SetNtupleMerging(true);
+G4String RootWriter::workerFileName(const G4String& name)
+{
+    const auto path = std::filesystem::path{std::string{name}};
+    const auto threadName = path.stem().string() + "_t" + std::to_string(G4Threading::G4GetThreadId());
+    return (path.parent_path() / (threadName + path.extension().string())).string();
 }
 
 void RootWriter::openRootFile(const G4String& name)
 {
-    analysisManager->OpenFile(name);
+    fileName = settings.perWorkerFiles && !isSequential ? workerFileName(name) : name;
+
+    if (backend)
+    {
+        record.reserve();
+        backend->open(fileName, record);
+    }
+
     createHistograms();
 }
 
 void RootWriter::closeRootFile()
 {
-    analysisManager->Write();
-    analysisManager->CloseFile();
-}
+    TRACE_ZONE("closeRootFile");
 
-void RootWriter::createHistograms()
-{
-    id_edepHisto = analysisManager->CreateH2("hs", "Deposited energy", 1000, 0, 300, 1000, -150, 150);
-    analysisManager->SetH2XAxisTitle(id_edepHisto, "z(mm)");
-    analysisManager->SetH2YAxisTitle(id_edepHisto, "x(mm)");
+    if (backend)
+        backend->close();
 
-    id_tree = analysisManager->CreateNtuple("tree", "tree");
+    if (settings.nucleiMap)
+        nucleiMap.flush();
 
-    if (!settings.minimalTreeForTransverseGammas)
+    // the workers close before the master
+    if (ownsFile)
+        summary.write(fileName);
+    else if (isWorker)
     {
-        id_eventID = analysisManager->CreateNtupleIColumn(id_tree, "eventID");
-        id_primaryEndX = analysisManager->CreateNtupleFColumn(id_tree, "primaryEndX");
-        id_primaryEndY = analysisManager->CreateNtupleFColumn(id_tree, "primaryEndY");
-        id_primaryEndZ = analysisManager->CreateNtupleFColumn(id_tree, "primaryEndZ");
-
-        // positron emission
-        analysisManager->CreateNtupleIColumn(id_tree, "A", AVec);
-        analysisManager->CreateNtupleIColumn(id_tree, "Z", ZVec);
-        analysisManager->CreateNtupleFColumn(id_tree, "x", xVec);
-        analysisManager->CreateNtupleFColumn(id_tree, "y", yVec);
-        analysisManager->CreateNtupleFColumn(id_tree, "z", zVec);
-        analysisManager->CreateNtupleFColumn(id_tree, "t", tVec);
-
-        // general nuclei position
-        analysisManager->CreateNtupleIColumn(id_tree, "nucleiA", nucleiA);
-        analysisManager->CreateNtupleIColumn(id_tree, "nucleiZ", nucleiZ);
-        analysisManager->CreateNtupleFColumn(id_tree, "nucleiXPos", nucleiXPos);
-        analysisManager->CreateNtupleFColumn(id_tree, "nucleiYPos", nucleiYPos);
-        analysisManager->CreateNtupleFColumn(id_tree, "nucleiZPos", nucleiZPos);
-
-        analysisManager->CreateNtupleIColumn(id_tree, "pdgEsc", pdgEscaping);
+        std::lock_guard<std::mutex> lock{mergeMutex};
+        masterRootWriter->summary.merge(summary);
     }
 
-    analysisManager->CreateNtupleFColumn(id_tree, "xEsc", xEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "yEsc", yEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "zEsc", zEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "thetaEsc", thetaEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "phiEsc", phiEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "eEsc", eEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "timeEsc", timeEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "initialXEsc", initialXEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "initialYEsc", initialYEscaping);
-    analysisManager->CreateNtupleFColumn(id_tree, "initialZEsc", initialZEscaping);
-
-    if (settings.beamTree)
+    summary.clear();
+}
+
+void RootWriter::selectColumns()
+{
+    if (!settings.columns.empty())
     {
-        id_beamPosX = analysisManager->CreateNtupleFColumn(id_tree, "beamX");
-        id_beamPosY = analysisManager->CreateNtupleFColumn(id_tree, "beamY");
-        id_beamPosZ = analysisManager->CreateNtupleFColumn(id_tree, "beamZ");
-        id_beamMomX = analysisManager->CreateNtupleFColumn(id_tree, "beamPX");
-        id_beamMomY = analysisManager->CreateNtupleFColumn(id_tree, "beamPY");
-        id_beamMomZ = analysisManager->CreateNtupleFColumn(id_tree, "beamPZ");
-        id_beamEnergy = analysisManager->CreateNtupleFColumn(id_tree, "beamE");
+        record.setAllEnabled(false);
+        for (const auto& name : settings.columns)
+        {
+            if (!record.setColumnEnabled(name, true))
+                throw std::logic_error("unknown column : " + name);
+        }
+    }
+    else
+    {
+        if (settings.minimalTreeForTransverseGammas)
+        {
+            record.setGroupEnabled(ColumnGroup::Event, false);
+            record.setGroupEnabled(ColumnGroup::PositronEmitter, false);
+            record.setGroupEnabled(ColumnGroup::Nuclei, false);
+            record.pdgEsc.enabled = false;
+        }
+
+        record.setGroupEnabled(ColumnGroup::Beam, settings.beamTree);
+        record.setGroupEnabled(ColumnGroup::EventStats, settings.eventStats);
+    }
+
+    for (const auto& name : settings.dropColumns)
+    {
+        if (!record.setColumnEnabled(name, false))
+            throw std::logic_error("unknown column : " + name);
     }
 
-    analysisManager->FinishNtuple(id_tree);
+    // replaced by the escaping particle histograms
+    if (settings.escapingHistograms)
+        record.setGroupEnabled(ColumnGroup::Escaping, false);
+
+    // e.g. pdgEsc for a gammas trigger on the minimal tree
+    trigger.keepColumns(record);
+
+    // with the histograms the escaping particles never reach the record
+    if (settings.escapingHistograms && record.isGroupFilled(ColumnGroup::Escaping))
+        throw std::logic_error("the trigger needs the escaping particles in the tree, not in histograms");
+
+    writePositronEmitters = record.isGroupFilled(ColumnGroup::PositronEmitter) || activityProfiles.isEnabled();
+    writeNuclei = record.isGroupFilled(ColumnGroup::Nuclei) || settings.nucleiMap;
+    writeEscapingParticles = record.isGroupFilled(ColumnGroup::Escaping) || settings.escapingHistograms;
+    writeBeam = record.isGroupEnabled(ColumnGroup::Beam);
+    writeEventStats = record.isGroupEnabled(ColumnGroup::EventStats);
+
+    record.setCompact(settings.compactTree);
+}
+
+void RootWriter::createHistograms()
+{
+    auto histo = std::make_unique<TH2D>("hs", "Deposited energy;z(mm);x(mm)", 1000, 0, 300, 1000, -150, 150);
+    histo->SetDirectory(nullptr);
+    edepHisto = summary.book(std::move(histo));
+
+    // total number of simulated events = tree entries + nRejectedEvents
+    nRejectedEvents = summary.book(std::make_unique<TParameter<Long64_t>>("nRejectedEvents", 0));
+
+    if (settings.escapingHistograms)
+        escapingHistograms.book(summary);
+
+    if (settings.nucleiMap)
+        nucleiMap.book(summary);
+
+    activityProfiles.book(summary);
 }
 
 void RootWriter::setEventNumber(const G4int eventNumber)
 {
-    if (settings.minimalTreeForTransverseGammas)
-        return;
-    analysisManager->FillNtupleIColumn(id_tree, id_eventID, eventNumber);
+    record.eventID.set(firstEventNumber + eventNumber);
+
+    activityProfiles.beginEvent(firstEventNumber + eventNumber);
 }
 
 void RootWriter::addEdep(const CLHEP::Hep3Vector& pos, const double dE)
 {
-    analysisManager->FillH2(id_edepHisto, pos.z() / CLHEP::mm, pos.x() / CLHEP::mm, dE / CLHEP::MeV);
+    edepHisto->Fill(pos.z() / CLHEP::mm, pos.x() / CLHEP::mm, dE / CLHEP::MeV);
 }
 
 void RootWriter::setPrimaryEnd(const G4ThreeVector pos)
 {
-    if (settings.minimalTreeForTransverseGammas)
-        return;
-    analysisManager->FillNtupleFColumn(id_tree, id_primaryEndX, pos.x() / CLHEP::mm);
-    analysisManager->FillNtupleFColumn(id_tree, id_primaryEndY, pos.y() / CLHEP::mm);
-    analysisManager->FillNtupleFColumn(id_tree, id_primaryEndZ, pos.z() / CLHEP::mm);
+    record.primaryEndX.set(pos.x());
+    record.primaryEndY.set(pos.y());
+    record.primaryEndZ.set(pos.z());
 }
 
 void RootWriter::addPositronEmitter(const G4ParticleDefinition* particleDefinition,
                                     const G4ThreeVector&        position,
                                     const G4double              time)
 {
-    if (settings.minimalTreeForTransverseGammas)
-        return;
-    if (!particleDefinition)
+    if (!writePositronEmitters || !particleDefinition)
         return;
 
+    ALLOCATION_SCOPE(Writer);
+
     const auto A = particleDefinition->GetBaryonNumber();
     const auto Z = particleDefinition->GetAtomicNumber();
 
-    AVec.push_back(A);
-    ZVec.push_back(Z);
-    xVec.push_back(position.x() / CLHEP::mm);
-    yVec.push_back(position.y() / CLHEP::mm);
-    zVec.push_back(position.z() / CLHEP::mm);
-    tVec.push_back(time / CLHEP::s);
+    if (activityProfiles.isEnabled())
+        activityProfiles.add(A, Z, position.z(), time);
+
+    record.A.add(A);
+    record.Z.add(Z);
+    record.x.add(position.x());
+    record.y.add(position.y());
+    record.z.add(position.z());
+    record.t.add(time);
 }
 
 void RootWriter::addEscapingParticle(const G4Step* step)
 {
+    if (!writeEscapingParticles)
+        return;
+
+    ALLOCATION_SCOPE(Writer);
+
     const auto postStepPoint = step->GetPostStepPoint();
 
     const auto pdg = step->GetTrack()->GetDefinition()->GetPDGEncoding();
@@ -142,47 +252,52 @@ void RootWriter::addEscapingParticle(const G4Step* step)
     if (settings.minimalTreeForTransverseGammas && pdg != 22)
         return;
 
-    const auto energy = step->GetPostStepPoint()->GetTotalEnergy() / CLHEP::MeV;
-    const auto pos = postStepPoint->GetPosition() / CLHEP::mm;
     const auto mom = postStepPoint->GetMomentumDirection();
-    const auto time = postStepPoint->GetGlobalTime() / CLHEP::second;
 
     const auto theta = mom.theta();
     if (settings.minimalTreeForTransverseGammas && (theta < 85 * CLHEP::deg || theta > 95 * CLHEP::deg))
         return;
 
-    pdgEscaping.push_back(pdg);
-    eEscaping.push_back(energy);
-    timeEscaping.push_back(time);
+    const auto& pos = postStepPoint->GetPosition();
 
-    xEscaping.push_back(pos.x());
-    yEscaping.push_back(pos.y());
-    zEscaping.push_back(pos.z());
+    const auto trackInfo = static_cast<const TrackInformation*>(step->GetTrack()->GetUserInformation());
 
-    thetaEscaping.push_back(theta);
-    phiEscaping.push_back(mom.phi());
+    const auto& initialPosition = trackInfo->initialPosition;
 
-    const auto trackInfo = static_cast<const TrackInformation*>(step->GetTrack()->GetUserInformation());
+    if (settings.escapingHistograms)
+    {
+        escapingHistograms.fill(pdg, postStepPoint->GetTotalEnergy(), theta, mom.phi(), pos.z(), initialPosition.z());
+        return;
+    }
 
-    const auto initialPosition = trackInfo->initialPosition / CLHEP::mm;
+    record.pdgEsc.add(pdg);
+    record.eEsc.add(postStepPoint->GetTotalEnergy());
+    record.timeEsc.add(postStepPoint->GetGlobalTime());
 
-    initialXEscaping.push_back(initialPosition.x());
-    initialYEscaping.push_back(initialPosition.y());
-    initialZEscaping.push_back(initialPosition.z());
+    record.xEsc.add(pos.x());
+    record.yEsc.add(pos.y());
+    record.zEsc.add(pos.z());
+
+    record.thetaEsc.add(theta);
+    record.phiEsc.add(mom.phi());
+
+    record.initialXEsc.add(initialPosition.x());
+    record.initialYEsc.add(initialPosition.y());
+    record.initialZEsc.add(initialPosition.z());
 }
 
 void RootWriter::addBeamProperties(const CLHEP::Hep3Vector& pos, const CLHEP::Hep3Vector& mom, const G4double energy)
 {
-    if (!settings.beamTree)
+    if (!writeBeam)
         return;
 
-    analysisManager->FillNtupleFColumn(id_tree, id_beamPosX, pos.x() / CLHEP::mm);
-    analysisManager->FillNtupleFColumn(id_tree, id_beamPosY, pos.y() / CLHEP::mm);
-    analysisManager->FillNtupleFColumn(id_tree, id_beamPosZ, pos.z() / CLHEP::mm);
-    analysisManager->FillNtupleFColumn(id_tree, id_beamMomX, mom.x());
-    analysisManager->FillNtupleFColumn(id_tree, id_beamMomY, mom.y());
-    analysisManager->FillNtupleFColumn(id_tree, id_beamMomZ, mom.z());
-    analysisManager->FillNtupleFColumn(id_tree, id_beamEnergy, energy / CLHEP::MeV);
+    record.beamX.set(pos.x());
+    record.beamY.set(pos.y());
+    record.beamZ.set(pos.z());
+    record.beamPX.set(mom.x());
+    record.beamPY.set(mom.y());
+    record.beamPZ.set(mom.z());
+    record.beamE.set(energy);
 }
 
 void RootWriter::addStepLength(const G4double stepLength)
@@ -192,41 +307,61 @@ void RootWriter::addStepLength(const G4double stepLength)
 
 void RootWriter::addNuclei(const G4ParticleDefinition* particleDefinition, const G4ThreeVector& position)
 {
-    if (settings.minimalTreeForTransverseGammas)
+    if (!writeNuclei)
         return;
 
-    nucleiA.push_back(particleDefinition->GetBaryonNumber());
-    nucleiZ.push_back(particleDefinition->GetAtomicNumber());
-    nucleiXPos.push_back(position.x() / CLHEP::mm);
-    nucleiYPos.push_back(position.y() / CLHEP::mm);
-    nucleiZPos.push_back(position.z() / CLHEP::mm);
+    ALLOCATION_SCOPE(Writer);
+
+    const auto A = particleDefinition->GetBaryonNumber();
+    const auto Z = particleDefinition->GetAtomicNumber();
+
+    if (settings.nucleiMap)
+    {
+        nucleiMap.add(A, Z, position);
+        if (!nucleiMap.isKept(A, Z))
+            return;
+    }
+
+    record.nucleiA.add(A);
+    record.nucleiZ.add(Z);
+    record.nucleiXPos.add(position.x());
+    record.nucleiYPos.add(position.y());
+    record.nucleiZPos.add(position.z());
+}
+
+void RootWriter::setEventStats(const EventStats& stats)
+{
+    record.wallTime.set(stats.wallTime);
+    record.nSteps.set(stats.nSteps);
+    record.nTracks.set(stats.nTracks);
+    record.nGammas.set(stats.nGammas);
+    record.nElectrons.set(stats.nElectrons);
+    record.nNeutrons.set(stats.nNeutrons);
+    record.nProtons.set(stats.nProtons);
+    record.nIons.set(stats.nIons);
+    record.nOthers.set(stats.nOthers);
+    record.peakStack.set(stats.peakStack);
 }
 
 void RootWriter::fillTree()
 {
-    analysisManager->AddNtupleRow(id_tree);
-
-    AVec.clear();
-    ZVec.clear();
-    xVec.clear();
-    yVec.clear();
-    zVec.clear();
-    tVec.clear();
-    pdgEscaping.clear();
-    xEscaping.clear();
-    yEscaping.clear();
-    zEscaping.clear();
-    thetaEscaping.clear();
-    phiEscaping.clear();
-    eEscaping.clear();
-    timeEscaping.clear();
-    initialXEscaping.clear();
-    initialYEscaping.clear();
-    initialZEscaping.clear();
-
-    nucleiA.clear();
-    nucleiZ.clear();
-    nucleiXPos.clear();
-    nucleiYPos.clear();
-    nucleiZPos.clear();
+    TRACE_ZONE("fillTree");
+    ALLOCATION_SCOPE(Writer);
+
+    if (settings.compactTree)
+        record.encode(encoding);
+
+    // before the fill, which swaps the record with an empty buffer with the asynchronous output
+    RunMetrics::Counters::add(metrics.nBytes, record.payloadBytes());
+
+    backend->fill();
+
+    record.clear();
+}
+
+void RootWriter::rejectEvent()
+{
+    nRejectedEvents->SetVal(nRejectedEvents->GetVal() + 1);
+
+    record.clear();
 }
@@ -1,7 +1,9 @@
 #include "RunAction.h"
+#include "AllocationCounter.h"
 #include "EventAction.h"
 #include "RootWriter.h"
 #include "Settings.h"
+#include "Trace.h"
 
 #include <G4Run.hh>
 #include <G4RunManager.hh>
@@ -9,92 +11,107 @@
 #include <G4ios.hh>
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <memory>
+#include <sstream>
 #include <thread>
 
 #include <G4AnalysisManager.hh>
 
-RunAction::RunAction(const Settings& settings)
-    : settings(settings)
+RunAction::RunAction(const Settings& settings, ThreadPlacement* threadPlacement)
+    : threadPlacement(threadPlacement)
+    , settings(settings)
 {
     rootWriter = std::make_unique<RootWriter>(settings);
+
+    if (settings.profileProcesses)
+        processProfiler = std::make_unique<ProcessProfiler>();
+
+    if (settings.perfCounters)
+        perfCounters = std::make_unique<PerfCounters>();
 }
 
-void RunAction::BeginOfRunAction(const G4Run*)
+G4String RunAction::makeRunName(const Settings& settings)
 {
-    using namespace std::chrono_literals;
-
     G4String bodyType = "w";
     if (settings.bodyMaterial == "waterGel")
         bodyType = "wg";
     std::stringstream sstr;
     sstr << settings.particleName << "_" << int(std::round(settings.beamMeanEnergy)) << "_" << bodyType << "_"
          << settings.seed;
+    // only when it differs from the default, so that the usual names do not change
+    if (settings.bodyWidth != 15)
+        sstr << "_b" << settings.bodyWidth;
     if (settings.minimalTreeForTransverseGammas)
         sstr << "_gm";
+    if (settings.processIndex >= 0)
+        sstr << "_p" << settings.processIndex;
+
+    return sstr.str();
+}
+
+void RunAction::BeginOfRunAction(const G4Run*)
+{
+    TRACE_ZONE("BeginOfRunAction");
+
+    runName = makeRunName(settings);
+
+    rootWriter->setFirstEventNumber(settings.firstEvent);
+    rootWriter->openRootFile(runName + ".root");
+
+    if (processProfiler)
+        processProfiler->beginRun();
 
-    auto rootFileName = sstr.str();
+    // last, so that the output setup is not counted
+    if (perfCounters)
+        perfCounters->start();
 
-    rootWriter->openRootFile(rootFileName + ".root");
+    ALLOCATION_BEGIN_RUN();
 
     if (IsMaster())
     {
-        beginTime = std::chrono::steady_clock::now();
+        // at the first run, so that a forked process has its own status file
+        if (!runMetrics)
+            runMetrics = std::make_unique<RunMetrics>(settings.statusFile, settings.statusInterval);
 
         const auto runManager = G4RunManager::GetRunManager();
-        const auto nThreads = runManager->GetNumberOfThreads();
-        const auto nEventsToBeProcessed = runManager->GetNumberOfEventsToBeProcessed();
+        runMetrics->startSampling(runName, runManager->GetNumberOfEventsToBeProcessed(),
+                                  runManager->GetNumberOfThreads());
 
-        const auto threadLoop = [=](std::chrono::duration<double> interval) -> void
-        {
-            auto refTime = beginTime;
-            G4cout << nEventsToBeProcessed << " events on " << nThreads << " threads" << G4endl;
-
-            G4int nEventsProcessed = 0;
-            G4int nEventsLastCheck = nEventsProcessed;
+        if (threadPlacement)
+            threadPlacement->beginRun();
+    }
+}
 
-            while (nEventsProcessed < nEventsToBeProcessed)
-            {
-                const auto                          now = std::chrono::steady_clock::now();
-                const std::chrono::duration<double> deltaTime = now - refTime;
-                const std::chrono::duration<double> totalTime = now - beginTime;
-                refTime = now;
+void RunAction::EndOfRunAction(const G4Run* run)
+{
+    {
+        TRACE_ZONE("EndOfRunAction");
 
-                nEventsProcessed = EventAction::getNEventsProcessed();
+        if (perfCounters)
+            perfCounters->stop();
 
-                const auto nEventsDelta = nEventsProcessed - nEventsLastCheck;
-                nEventsLastCheck = nEventsProcessed;
+        rootWriter->closeRootFile();
 
-                const auto nEventsPerSec = nEventsDelta / deltaTime.count();
-                const auto timeRemaining = 1s * (nEventsToBeProcessed - nEventsProcessed) / nEventsPerSec;
+        if (processProfiler)
+            processProfiler->endRun();
 
-                G4cout << nEventsProcessed << "/" << nEventsToBeProcessed << " events \t total time "
-                       << totalTime.count() << " s "
-                       << "\t" << nEventsPerSec << " events/s \t time remaining : " << timeRemaining.count() << " s"
-                       << G4endl;
+        if (IsMaster())
+        {
+            runMetrics->stopSampling();
 
-                interval = 1s * std::min(interval.count(), (1.1 * timeRemaining).count());
-                std::this_thread::sleep_for(interval);
-            }
-        };
+            if (perfCounters)
+                perfCounters->report(run->GetNumberOfEvent());
 
-        printingThread = std::thread(threadLoop, 2s);
-        return;
+            if (threadPlacement)
+                threadPlacement->report();
+        }
     }
-}
-
-void RunAction::EndOfRunAction(const G4Run*)
-{
-    rootWriter->closeRootFile();
 
+    // the workers have ended their run, the master writes the zones and reports the allocations of all the threads
     if (IsMaster())
     {
-        printingThread.join();
-        const auto                          now = std::chrono::steady_clock::now();
-        const std::chrono::duration<double> totalTime = now - beginTime;
-
-        const auto nEventsProcessed = EventAction::getNEventsProcessed();
-        G4cout << nEventsProcessed << " events processed in " << totalTime.count()
-               << " s : " << nEventsProcessed / totalTime.count() << " events/s" << G4endl;
+        TRACE_WRITE(runName + "_trace.json");
+        ALLOCATION_REPORT();
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,50 @@
+#include "RunManagerFactory.h"
+#include "Settings.h"
+
+#include <G4MTRunManager.hh>
+#include <G4RunManagerFactory.hh>
+#include <G4ios.hh>
+
+#include <map>
+#include <stdexcept>
+
+namespace
+{
+// the Only types fail rather than fall back on another run manager, so that a benchmark runs what it was asked for
+const std::map<G4String, G4RunManagerType> runManagerTypes{{"serial", G4RunManagerType::SerialOnly},
+                                                            {"mt", G4RunManagerType::MTOnly},
+                                                            {"tasking", G4RunManagerType::TaskingOnly},
+                                                            {"tbb", G4RunManagerType::TBBOnly}};
+} // namespace
+
+void RunManagerFactory::checkType(const G4String& type)
+{
+    if (!runManagerTypes.count(type))
+        throw std::logic_error("run manager must be serial, mt, tasking or tbb");
+}
+
+G4RunManager* RunManagerFactory::create(const Settings& settings)
+{
+    checkType(settings.runManagerType);
+
+    auto runManager = G4RunManagerFactory::CreateRunManager(runManagerTypes.at(settings.runManagerType));
+    runManager->SetNumberOfThreads(settings.nThreads);
+
+    // G4TaskRunManager is a G4MTRunManager, the modulo sets the number of events per task
+    const auto mtRunManager = dynamic_cast<G4MTRunManager*>(runManager);
+    if (mtRunManager && settings.eventModulo > 0)
+        mtRunManager->SetEventModulo(settings.eventModulo);
+
+    G4cout << "run manager : " << settings.runManagerType;
+    if (mtRunManager)
+    {
+        G4cout << ", " << settings.nThreads << " threads, event modulo ";
+        if (settings.eventModulo > 0)
+            G4cout << settings.eventModulo;
+        else
+            G4cout << "chosen by Geant4";
+    }
+    G4cout << G4endl;
+
+    return runManager;
+}
@@ -0,0 +1,175 @@
+#include "RunMetrics.h"
+
+#include <G4ios.hh>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <vector>
+
+namespace
+{
+// the counters outlive their thread, they are registered once per thread
+std::mutex                                          countersMutex{};
+std::vector<std::unique_ptr<RunMetrics::Counters>> allCounters{};
+} // namespace
+
+RunMetrics::Counters& RunMetrics::threadCounters()
+{
+    thread_local const auto counters = []
+    {
+        std::lock_guard<std::mutex> lock{countersMutex};
+        allCounters.push_back(std::make_unique<Counters>());
+        return allCounters.back().get();
+    }();
+
+    return *counters;
+}
+
+RunMetrics::Totals RunMetrics::sum()
+{
+    Totals totals{};
+
+    std::lock_guard<std::mutex> lock{countersMutex};
+    for (const auto& counters : allCounters)
+    {
+        totals.nEvents += counters->nEvents.load(std::memory_order_relaxed);
+        totals.nSteps += counters->nSteps.load(std::memory_order_relaxed);
+        totals.nTracks += counters->nTracks.load(std::memory_order_relaxed);
+        totals.nBytes += counters->nBytes.load(std::memory_order_relaxed);
+    }
+
+    return totals;
+}
+
+RunMetrics::RunMetrics(const G4String& statusFile, const G4double interval)
+    : statusFile(statusFile)
+    , interval(interval)
+{
+}
+
+RunMetrics::~RunMetrics()
+{
+    if (samplerThread.joinable())
+        stopSampling();
+}
+
+void RunMetrics::startSampling(const G4String& name, const G4int nEvents, const G4int nThreadsUsed)
+{
+    runName = name;
+    nEventsToBeProcessed = nEvents;
+    nThreads = nThreadsUsed;
+
+    baseline = sum();
+    beginTime = std::chrono::steady_clock::now();
+    stop = false;
+
+    G4cout << nEventsToBeProcessed << " events on " << nThreads << " threads" << G4endl;
+
+    samplerThread = std::thread(&RunMetrics::samplerLoop, this);
+}
+
+void RunMetrics::stopSampling()
+{
+    {
+        std::lock_guard<std::mutex> lock{stopMutex};
+        stop = true;
+    }
+    stopCondition.notify_one();
+    samplerThread.join();
+
+    const std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - beginTime;
+
+    const auto run = sum() - baseline;
+
+    report(run, Rates{run, totalTime.count()}, true);
+}
+
+void RunMetrics::samplerLoop()
+{
+    auto refTime = beginTime;
+    auto previous = baseline;
+    auto lock = std::unique_lock<std::mutex>{stopMutex};
+
+    while (!stopCondition.wait_for(lock, interval, [this] { return stop; }))
+    {
+        const auto                          now = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> deltaTime = now - refTime;
+        refTime = now;
+
+        const auto totals = sum();
+
+        report(totals - baseline, Rates{totals - previous, deltaTime.count()}, false);
+        previous = totals;
+    }
+}
+
+void RunMetrics::report(const Totals& run, const Rates& rates, const G4bool done) const
+{
+    const std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - beginTime;
+
+    const auto nRemaining = nEventsToBeProcessed - static_cast<G4double>(run.nEvents);
+    const auto eta = nRemaining <= 0 ? 0. : rates.nEvents > 0 ? nRemaining / rates.nEvents : -1.;
+
+    if (done)
+        G4cout << run.nEvents << " events processed in " << totalTime.count() << " s : " << rates.nEvents
+               << " events/s, " << rates.nSteps << " steps/s, " << rates.nBytes / 1e6 << " MB/s" << G4endl;
+    else
+        G4cout << run.nEvents << "/" << nEventsToBeProcessed << " events \t total time " << totalTime.count()
+               << " s \t" << rates.nEvents << " events/s \t time remaining : " << eta << " s" << G4endl;
+
+    if (!statusFile.empty())
+        writeStatus(run, rates, done ? 0. : eta, done);
+}
+
+void RunMetrics::writeStatus(const Totals& run, const Rates& rates, const G4double eta, const G4bool done) const
+{
+    const std::chrono::duration<double> totalTime = std::chrono::steady_clock::now() - beginTime;
+
+    // written next to the final files then renamed, so that readers never see a partial file
+    const auto jsonFile = statusFile + ".json";
+    {
+        std::ofstream json{jsonFile + ".tmp"};
+        json << "{\n"
+             << "  \"run\": \"" << runName << "\",\n"
+             << "  \"state\": \"" << (done ? "done" : "running") << "\",\n"
+             << "  \"threads\": " << nThreads << ",\n"
+             << "  \"elapsed_seconds\": " << totalTime.count() << ",\n"
+             << "  \"eta_seconds\": " << eta << ",\n"
+             << "  \"events\": " << run.nEvents << ",\n"
+             << "  \"events_to_process\": " << nEventsToBeProcessed << ",\n"
+             << "  \"steps\": " << run.nSteps << ",\n"
+             << "  \"tracks\": " << run.nTracks << ",\n"
+             << "  \"bytes\": " << run.nBytes << ",\n"
+             << "  \"events_per_second\": " << rates.nEvents << ",\n"
+             << "  \"steps_per_second\": " << rates.nSteps << ",\n"
+             << "  \"tracks_per_second\": " << rates.nTracks << ",\n"
+             << "  \"bytes_per_second\": " << rates.nBytes << "\n"
+             << "}\n";
+    }
+    std::rename((jsonFile + ".tmp").c_str(), jsonFile.c_str());
+
+    const auto promFile = statusFile + ".prom";
+    {
+        std::ofstream prom{promFile + ".tmp"};
+
+        const auto metric = [&](const char* name, const char* type, const char* help, const auto value)
+        {
+            prom << "# HELP carbontherapy_" << name << " " << help << "\n"
+                 << "# TYPE carbontherapy_" << name << " " << type << "\n"
+                 << "carbontherapy_" << name << "{run=\"" << runName << "\"} " << value << "\n";
+        };
+
+        metric("events_total", "counter", "Events processed in the run", run.nEvents);
+        metric("steps_total", "counter", "Steps in the run", run.nSteps);
+        metric("tracks_total", "counter", "Tracks in the run", run.nTracks);
+        metric("bytes_total", "counter", "Tree payload bytes before compression", run.nBytes);
+        metric("events_to_process", "gauge", "Events of the run", nEventsToBeProcessed);
+        metric("events_per_second", "gauge", "Event rate over the last interval", rates.nEvents);
+        metric("eta_seconds", "gauge", "Remaining time, -1 if unknown", eta);
+        metric("elapsed_seconds", "gauge", "Time since the beginning of the run", totalTime.count());
+        metric("threads", "gauge", "Worker threads", nThreads);
+        metric("done", "gauge", "1 once the run has ended", done ? 1 : 0);
+    }
+    std::rename((promFile + ".tmp").c_str(), promFile.c_str());
+}
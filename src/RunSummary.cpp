@@ -0,0 +1,40 @@
+#include "RunSummary.h"
+
+#include <TClass.h>
+#include <TFile.h>
+#include <TList.h>
+
+#include <stdexcept>
+
+void RunSummary::merge(const RunSummary& other)
+{
+    if (other.objects.size() != objects.size())
+        throw std::logic_error("RunSummary::merge : the summaries were not booked the same way");
+
+    for (auto i = 0U; i < objects.size(); ++i)
+    {
+        auto&      object = objects[i];
+        const auto mergeFunction = object->IsA()->GetMerge();
+        if (!mergeFunction)
+            throw std::logic_error(std::string{"RunSummary::merge : cannot merge "} + object->ClassName());
+
+        TList list{};
+        list.Add(other.objects[i].get());
+        mergeFunction(object.get(), &list, nullptr);
+    }
+}
+
+void RunSummary::write(const std::string& fileName) const
+{
+    if (objects.empty())
+        return;
+
+    auto file = std::unique_ptr<TFile>{TFile::Open(fileName.c_str(), "UPDATE")};
+    if (!file || file->IsZombie())
+        throw std::runtime_error("RunSummary::write : cannot open " + fileName);
+
+    for (const auto& object : objects)
+        object->Write();
+
+    file->Close();
+}
@@ -1,4 +1,6 @@
 #include "SteppingAction.h"
+#include "AllocationCounter.h"
+#include "ProcessProfiler.h"
 #include "RootWriter.h"
 #include "Settings.h"
 #include "TrackInformation.h"
@@ -16,15 +18,24 @@
 #include <G4ios.hh>
 #include <ROOT/RDF/InterfaceUtils.hxx>
 
-SteppingAction::SteppingAction(RootWriter* rootWriter, TrackingAction* trackingAction, const Settings& settings)
+SteppingAction::SteppingAction(RootWriter*      rootWriter,
+                               TrackingAction*  trackingAction,
+                               ProcessProfiler* processProfiler,
+                               const Settings&  settings)
     : rootWriter(rootWriter)
     , trackingAction(trackingAction)
+    , processProfiler(processProfiler)
     , omitNeutrons(settings.omitNeutrons)
 {
 }
 
 void SteppingAction::UserSteppingAction(const G4Step* step)
 {
+    ALLOCATION_SCOPE(Stepping);
+
+    if (processProfiler)
+        processProfiler->addStep(step);
+
     const auto track = step->GetTrack();
     // if the step is exiting the world we don't care
     if (!track->GetNextVolume())
@@ -49,7 +60,7 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
     if (regionName == "Body")
     {
         HandleBeamInBody(step);
-        if (postName == "World" && trackInfo->doComeFromBody)
+        if (postName == "World" && trackInfo->doComeFromBody && rootWriter->doWriteEscapingParticles())
         {
             bool write = true;
             if (omitNeutrons && particleDefinition->GetPDGEncoding() == 2112)
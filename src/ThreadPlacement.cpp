@@ -0,0 +1,200 @@
+#include "ThreadPlacement.h"
+
+#include <G4ios.hh>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+namespace
+{
+// -1 if the file is missing
+G4int readTopologyValue(const G4int cpu, const std::string& name)
+{
+    std::ifstream file{"/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/" + name};
+    G4int         value = -1;
+    if (!(file >> value))
+        return -1;
+    return value;
+}
+} // namespace
+
+ThreadPlacement::ThreadPlacement(const G4String& policy)
+    : policy(policy)
+{
+    const auto topology = readTopology();
+
+    if (topology.empty())
+    {
+        G4cout << "thread placement : only available on Linux" << G4endl;
+        return;
+    }
+
+    cpus = topology;
+
+    if (policy == "compact")
+    {
+        std::stable_sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b)
+                         { return std::tie(a.socket, a.sibling, a.core) < std::tie(b.socket, b.sibling, b.core); });
+    }
+    else if (policy == "scatter")
+    {
+        std::stable_sort(cpus.begin(), cpus.end(), [](const Cpu& a, const Cpu& b)
+                         { return std::tie(a.sibling, a.core, a.socket) < std::tie(b.sibling, b.core, b.socket); });
+    }
+    else
+    {
+        cpus.clear();
+
+        std::stringstream list{policy};
+        std::string       token{};
+        while (std::getline(list, token, ','))
+        {
+            if (token.empty() || token.find_first_not_of("0123456789") != std::string::npos)
+                throw std::logic_error("affinity must be compact, scatter or a comma separated list of CPUs");
+
+            const auto id = std::stoi(token);
+            const auto cpu =
+                std::find_if(topology.begin(), topology.end(), [id](const Cpu& allowed) { return allowed.id == id; });
+            if (cpu == topology.end())
+                throw std::logic_error("CPU " + token + " is not available to the process");
+
+            cpus.push_back(*cpu);
+        }
+    }
+
+    std::set<G4int> sockets{};
+    for (const auto& cpu : cpus)
+        sockets.insert(cpu.socket);
+
+    G4cout << "thread placement : " << policy << " over " << cpus.size() << " CPUs on " << sockets.size()
+           << " sockets" << G4endl;
+}
+
+std::vector<ThreadPlacement::Cpu> ThreadPlacement::readTopology()
+{
+    std::vector<Cpu> topology{};
+
+#ifdef __linux__
+    cpu_set_t allowed{};
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+        return topology;
+
+    // physical cores per socket, in the order of their first CPU
+    std::map<std::pair<G4int, G4int>, G4int> coreRanks{};
+    std::map<G4int, G4int>                   nCores{};
+    std::map<std::pair<G4int, G4int>, G4int> nSiblings{};
+
+    for (auto id = 0; id < CPU_SETSIZE; ++id)
+    {
+        if (!CPU_ISSET(id, &allowed))
+            continue;
+
+        // a single socket and no hyperthreads if the topology is not exposed
+        const auto socket = std::max(readTopologyValue(id, "physical_package_id"), 0);
+        const auto coreID = readTopologyValue(id, "core_id");
+        const auto core = std::make_pair(socket, coreID >= 0 ? coreID : id);
+
+        if (!coreRanks.count(core))
+            coreRanks[core] = nCores[socket]++;
+
+        topology.push_back({id, socket, coreRanks[core], nSiblings[core]++});
+    }
+#endif
+
+    return topology;
+}
+
+void ThreadPlacement::pin(const G4int threadID)
+{
+    if (cpus.empty())
+        return;
+
+    // the sequential run manager has no worker ID
+    const auto index = static_cast<std::size_t>(std::max(threadID, 0));
+    const auto cpu = cpus[index % cpus.size()];
+
+    if (index == cpus.size())
+        G4cout << "thread placement : more threads than CPUs, the CPUs are shared from thread " << index << G4endl;
+
+#ifdef __linux__
+    cpu_set_t set{};
+    CPU_ZERO(&set);
+    CPU_SET(cpu.id, &set);
+
+    const auto error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (error != 0)
+        G4cout << "thread placement : cannot pin thread " << index << " to CPU " << cpu.id << " ("
+               << std::strerror(error) << ")" << G4endl;
+#endif
+
+    const auto& counters = RunMetrics::threadCounters();
+
+    std::lock_guard<std::mutex> lock{threadsMutex};
+    threads.push_back({cpu.socket, &counters, counters.nEvents.load(std::memory_order_relaxed)});
+}
+
+void ThreadPlacement::beginRun()
+{
+    std::lock_guard<std::mutex> lock{threadsMutex};
+
+    // the MT workers of the first run are pinned after this
+    for (auto& thread : threads)
+        thread.nEventsAtBeginOfRun = thread.counters->nEvents.load(std::memory_order_relaxed);
+
+    beginTime = std::chrono::steady_clock::now();
+}
+
+void ThreadPlacement::report() const
+{
+    const std::chrono::duration<double> runTime = std::chrono::steady_clock::now() - beginTime;
+
+    // threads and events per socket
+    std::map<G4int, std::pair<G4int, std::uint64_t>> sockets{};
+    {
+        std::lock_guard<std::mutex> lock{threadsMutex};
+        for (const auto& thread : threads)
+        {
+            auto& [nThreads, nEvents] = sockets[thread.socket];
+            nThreads++;
+            nEvents += thread.counters->nEvents.load(std::memory_order_relaxed) - thread.nEventsAtBeginOfRun;
+        }
+    }
+
+    if (sockets.empty() || runTime.count() <= 0)
+        return;
+
+    // the sockets with remote memory or more contention get a lower rate per thread
+    G4double maxThreadRate = 0;
+    for (const auto& [socket, socketThreads] : sockets)
+        maxThreadRate = std::max(maxThreadRate, socketThreads.second / runTime.count() / socketThreads.first);
+
+    G4cout << "events per socket (" << policy << " placement)" << G4endl;
+    G4cout << std::setw(8) << "socket" << std::setw(10) << "threads" << std::setw(12) << "events" << std::setw(12)
+           << "events/s" << std::setw(20) << "events/s/thread" << std::setw(12) << "efficiency" << G4endl;
+
+    for (const auto& [socket, socketThreads] : sockets)
+    {
+        const auto [nThreads, nEvents] = socketThreads;
+        const auto rate = nEvents / runTime.count();
+        const auto threadRate = rate / nThreads;
+
+        G4cout << std::setw(8) << socket << std::setw(10) << nThreads << std::setw(12) << nEvents << std::fixed
+               << std::setprecision(1) << std::setw(12) << rate << std::setw(20) << threadRate << std::setprecision(3)
+               << std::setw(12) << (maxThreadRate > 0 ? threadRate / maxThreadRate : 0.) << G4endl;
+    }
+}
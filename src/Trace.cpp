@@ -0,0 +1,111 @@
+#ifdef WITH_TRACING
+
+#include "Trace.h"
+
+#include <G4Threading.hh>
+#include <G4Types.hh>
+#include <G4ios.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+struct ZoneRecord
+{
+    const char*   name;
+    std::uint64_t begin;
+    std::uint64_t end;
+};
+
+// the oldest zones are overwritten once full
+struct ThreadBuffer
+{
+    static constexpr std::size_t capacity = 1 << 16;
+
+    G4int                   threadID = 0;
+    std::vector<ZoneRecord> zones = std::vector<ZoneRecord>(capacity);
+    std::size_t             nRecorded = 0;
+};
+
+// the buffers outlive their thread so that the master can write them
+std::mutex                                 buffersMutex{};
+std::vector<std::shared_ptr<ThreadBuffer>> buffers{};
+
+const auto epoch = std::chrono::steady_clock::now();
+
+ThreadBuffer& threadBuffer()
+{
+    thread_local const auto buffer = []
+    {
+        auto newBuffer = std::make_shared<ThreadBuffer>();
+        newBuffer->threadID = G4Threading::G4GetThreadId();
+
+        std::lock_guard<std::mutex> lock{buffersMutex};
+        buffers.push_back(newBuffer);
+        return newBuffer;
+    }();
+
+    return *buffer;
+}
+} // namespace
+
+std::uint64_t Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Trace::record(const char* name, const std::uint64_t begin, const std::uint64_t end)
+{
+    auto& buffer = threadBuffer();
+    buffer.zones[buffer.nRecorded++ % ThreadBuffer::capacity] = {name, begin, end};
+}
+
+void Trace::write(const std::string& fileName)
+{
+    std::ofstream file{fileName};
+    file << std::fixed << std::setprecision(3);
+    file << "{\"traceEvents\":[";
+
+    // one event per line, Chrome trace times are in us
+    auto       first = true;
+    const auto separator = [&]
+    {
+        const auto result = first ? "\n" : ",\n";
+        first = false;
+        return result;
+    };
+
+    std::lock_guard<std::mutex> lock{buffersMutex};
+    for (const auto& buffer : buffers)
+    {
+        const auto tid = buffer->threadID + 1;
+        const auto threadName = buffer->threadID < 0 ? std::string{"master"} : "G4WT" + std::to_string(tid - 1);
+
+        file << separator() << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << tid
+             << R"(,"args":{"name":")" << threadName << "\"}}";
+
+        const auto nZones = std::min(buffer->nRecorded, ThreadBuffer::capacity);
+        for (auto i = buffer->nRecorded - nZones; i < buffer->nRecorded; ++i)
+        {
+            const auto& zone = buffer->zones[i % ThreadBuffer::capacity];
+            file << separator() << R"({"name":")" << zone.name << R"(","ph":"X","pid":0,"tid":)" << tid
+                 << ",\"ts\":" << zone.begin / 1e3 << ",\"dur\":" << (zone.end - zone.begin) / 1e3 << "}";
+        }
+
+        if (buffer->nRecorded > ThreadBuffer::capacity)
+            G4cout << "trace : " << buffer->nRecorded - ThreadBuffer::capacity << " zones of thread " << threadName
+                   << " were overwritten" << G4endl;
+
+        buffer->nRecorded = 0;
+    }
+
+    file << "\n]}\n";
+}
+
+#endif
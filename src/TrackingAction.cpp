@@ -1,25 +1,34 @@
 #include "TrackingAction.h"
+#include "AllocationCounter.h"
 #include "EventAction.h"
 #include "ParticleMemory.h"
+#include "ProcessProfiler.h"
 #include "RootWriter.h"
 #include "TrackInformation.h"
 
 #include <CLHEP/Matrix/GenMatrix.h>
 #include <CLHEP/Units/SystemOfUnits.h>
+#include <G4EventManager.hh>
 #include <G4ParticleDefinition.hh>
 #include <G4ProcessType.hh>
+#include <G4StackManager.hh>
 #include <G4SystemOfUnits.hh>
 #include <G4Track.hh>
 #include <G4VProcess.hh>
 #include <G4ios.hh>
 
-TrackingAction::TrackingAction(RootWriter* rootWriter)
+TrackingAction::TrackingAction(RootWriter* rootWriter, ProcessProfiler* processProfiler)
     : rootWriter(rootWriter)
+    , processProfiler(processProfiler)
+    , metrics(RunMetrics::threadCounters())
+    , collectEventStats(rootWriter->doWriteEventStats())
 {
 }
 
 void TrackingAction::PreUserTrackingAction(const G4Track* track)
 {
+    ALLOCATION_SCOPE(Tracking);
+
     const auto trackID = track->GetTrackID();
     const auto parentID = track->GetParentID();
     const auto particleDefinition = track->GetParticleDefinition();
@@ -51,20 +60,40 @@ void TrackingAction::PreUserTrackingAction(const G4Track* track)
 
     track->SetUserInformation(trackInfo);
 
-    if (particleDefinition->GetAtomicNumber() > 0)
+    RunMetrics::Counters::add(metrics.nTracks, 1);
+
+    if (collectEventStats)
+    {
+        const auto stackManager = G4EventManager::GetEventManager()->GetStackManager();
+        eventStats.addTrack(particleDefinition, stackManager->GetNTotalTrack());
+    }
+
+    if (rootWriter->doWriteNuclei() && particleDefinition->GetAtomicNumber() > 0)
         rootWriter->addNuclei(particleDefinition, initialPosition);
 
-    if (particleDefinition->GetPDGEncoding() == -11)
+    if (rootWriter->doWritePositronEmitters() && particleDefinition->GetPDGEncoding() == -11)
         rootWriter->addPositronEmitter(parentParticleDefinition, initialPosition, initialTime);
+
+    // the tracking action itself is not charged to the first step
+    if (processProfiler)
+        processProfiler->startTrack();
 }
 
 void TrackingAction::PostUserTrackingAction(const G4Track* track)
 {
+    ALLOCATION_SCOPE(Tracking);
+
     const auto trackID = track->GetTrackID();
 
     particleMemoryMap.at(trackID).finalEnergy = track->GetKineticEnergy();
     particleMemoryMap.at(trackID).finalPosition = track->GetPosition();
 
+    // counted per track rather than in the stepping action
+    const auto nSteps = track->GetCurrentStepNumber();
+    RunMetrics::Counters::add(metrics.nSteps, nSteps);
+    if (collectEventStats)
+        eventStats.nSteps += nSteps;
+
     if (track->GetTrackID() != 1)
         return;
 
@@ -122,4 +151,5 @@ void TrackingAction::reset()
     parentChildrenRelationMap.clear();
     particleMemoryMap.clear();
     printParticleMemoryMap = false;
+    eventStats = {};
 }
@@ -0,0 +1,92 @@
+#include "TreeBackend.h"
+#include "EventRecord.h"
+
+#include <TROOT.h>
+#include <TTree.h>
+
+#include <type_traits>
+
+std::shared_ptr<ROOT::TBufferMerger> TreeBackend::masterBufferMerger = nullptr;
+
+TreeBackend::TreeBackend(const Settings& settings, const G4bool isMaster, const G4bool isWorker)
+    : settings(settings)
+    , isMaster(isMaster)
+    , isWorker(isWorker)
+{
+    // throws early on a wrong algorithm name
+    compressionSettings(settings.compressionAlgorithm, settings.compressionLevel);
+}
+
+void TreeBackend::open(const std::string& fileName, EventRecord& record)
+{
+    // the master opens before the workers start their run
+    if (isMaster)
+    {
+        ROOT::EnableThreadSafety();
+
+        const auto compression = compressionSettings(settings.compressionAlgorithm, settings.compressionLevel);
+        bufferMerger = std::make_shared<ROOT::TBufferMerger>(fileName.c_str(), "RECREATE", compression);
+
+        if (!isWorker)
+        {
+            masterBufferMerger = bufferMerger;
+            return;
+        }
+    }
+    else
+        bufferMerger = masterBufferMerger;
+
+    file = bufferMerger->GetFile();
+    file->cd();
+
+    tree = new TTree("tree", "tree");
+    tree->SetAutoFlush(settings.autoFlush);
+
+    record.forEachColumn(
+        [&](auto& column)
+        {
+            if (!column.enabled)
+                return;
+
+            using Column = std::decay_t<decltype(column)>;
+
+            // the compact columns are 16 bit here, unlike with G4AnalysisBackend
+            if constexpr (Column::isVector)
+            {
+                if (column.compact)
+                    tree->Branch(column.name, &column.codes, settings.basketSize);
+                else
+                    tree->Branch(column.name, &column.data, settings.basketSize);
+            }
+            else
+                tree->Branch(column.name, &column.value, settings.basketSize);
+        });
+
+    bytesSinceWrite = 0;
+}
+
+void TreeBackend::fill()
+{
+    bytesSinceWrite += tree->Fill();
+
+    if (bytesSinceWrite > writeInterval)
+    {
+        file->Write();
+        bytesSinceWrite = 0;
+    }
+}
+
+void TreeBackend::close()
+{
+    if (isWorker)
+    {
+        file->Write();
+        tree = nullptr;
+        file.reset();
+    }
+
+    // the master closes after all the workers, destroying the merger writes the output file
+    if (isMaster && !isWorker)
+        masterBufferMerger.reset();
+    bufferMerger.reset();
+}